@@ -0,0 +1,63 @@
+/************************************************************************//**
+ * (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *    License for the specific language governing permissions and limitations
+ *    under the License.
+ *
+ ***************************************************************************/
+/* @ingroup ops-sysd
+ *
+ * @file
+ * Header for the ops-sysd arena allocator.
+ */
+
+#ifndef __SYSD_ARENA_H__
+#define __SYSD_ARENA_H__
+
+/** @ingroup ops-sysd
+ * @{ */
+
+#include <stddef.h>
+
+/* Chunk size used by arenas initialized with a 'chunk_size' of 0. */
+#define SYSD_ARENA_DEFAULT_CHUNK    4096
+
+struct sysd_arena_chunk;
+
+/*************************************************************************//**
+ * A bump allocator for objects that share a lifetime. Memory is carved out
+ * of large chunks and is only given back, all at once, by
+ * sysd_arena_destroy(); there is no way to free a single object.
+ ****************************************************************************/
+struct sysd_arena {
+    struct sysd_arena_chunk *chunks;    /*!< Current chunk first. */
+    size_t                  chunk_size; /*!< 0 for the default. */
+    size_t                  n_bytes;    /*!< Handed out to callers. */
+    size_t                  allocated;  /*!< Obtained from malloc. */
+};
+
+#define SYSD_ARENA_INITIALIZER { NULL, 0, 0, 0 }
+
+/* Boot-time objects that live as long as sysd: the h/w description
+ * directory, the subsystem table and the management interface. */
+extern struct sysd_arena sysd_boot_arena;
+
+void sysd_arena_init(struct sysd_arena *arena, size_t chunk_size);
+void sysd_arena_destroy(struct sysd_arena *arena);
+void *sysd_arena_alloc(struct sysd_arena *arena, size_t size);
+void *sysd_arena_calloc(struct sysd_arena *arena, size_t n, size_t size);
+char *sysd_arena_strdup(struct sysd_arena *arena, const char *str);
+char *sysd_arena_memdup0(struct sysd_arena *arena, const void *data,
+                         size_t len);
+
+/** @} end of group ops-sysd */
+#endif /* __SYSD_ARENA_H__ */
@@ -0,0 +1,131 @@
+/************************************************************************//**
+ * (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *    License for the specific language governing permissions and limitations
+ *    under the License.
+ *
+ ***************************************************************************/
+/* @ingroup ops-sysd
+ *
+ * @file
+ * Header for the ops-sysd daemon registry.
+ */
+
+#ifndef __SYSD_DAEMON_H__
+#define __SYSD_DAEMON_H__
+
+/** @ingroup ops-sysd
+ * @{ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <hmap.h>
+#include <shash.h>
+
+#include "sysd_arena.h"
+
+#define MAX_DAEMON_NAME_LEN     128
+
+struct ovsdb_idl;
+struct ovsrec_daemon;
+struct simap;
+
+/*************************************************************************//**
+ * A readiness stage. A stage is ready once every daemon assigned to it in
+ * the image.manifest file is ready.
+ ****************************************************************************/
+typedef struct sysd_daemon_stage {
+    char                *name;
+    size_t              n_daemons;
+    size_t              n_ready;
+    bool                published;  /*!< Ready marker written to the db. */
+} sysd_daemon_stage_t;
+
+/*************************************************************************//**
+ * Per daemon data read from the image.manifest file.
+ *
+ * A daemon is ready when it has set Daemon:cur_hw (daemons that are not
+ * h/w handlers are always ready on their own) and every daemon listed in
+ * its depends_on list is ready.
+ ****************************************************************************/
+typedef struct daemon_info {
+    struct hmap_node            hmap_node;  /*!< In registry 'by_name'. */
+    char                        name[MAX_DAEMON_NAME_LEN];
+    bool                        is_hw_handler;
+    int64_t                     cur_hw;
+    const struct ovsrec_daemon  *row;       /*!< Daemon table row, if any. */
+
+    sysd_daemon_stage_t         *stage;     /*!< NULL if not staged. */
+    char                        **depends_on;
+    size_t                      n_depends_on;
+    size_t                      *deps;      /*!< Resolved registry indexes. */
+    size_t                      n_deps;
+    bool                        ready;
+
+    bool                        seen_not_ready;  /*!< cur_hw seen as 0. */
+    bool                        hw_ready_recorded;
+    bool                        hw_ready_published;
+    long long int               hw_ready_msec;  /*!< From sysd start. */
+
+    long long int               ready_timeout_msec; /*!< 0 if no deadline. */
+    bool                        deadline_missed;
+} daemon_info_t;
+
+/*************************************************************************//**
+ * All daemons listed in the image.manifest file. The entries are kept in
+ * one contiguous array, in manifest order, and are indexed by exact name.
+ ****************************************************************************/
+typedef struct sysd_daemon_registry {
+    daemon_info_t       *daemons;
+    size_t              n_daemons;
+    size_t              allocated;
+    size_t              n_hw_daemons;   /*!< Daemons with is_hw_handler set. */
+    struct hmap         by_name;
+    struct shash        stages;         /*!< sysd_daemon_stage_t by name. */
+    size_t              *order;         /*!< Dependency (topological) order. */
+    struct sysd_arena   arena;          /*!< Stages and dependency names. */
+
+    /* Readiness watchdog settings from the manifest "readiness" object. */
+    long long int       default_timeout_msec;   /*!< 0 if no deadline. */
+    size_t              quorum;         /*!< Ready h/w daemons needed to
+                                             proceed past missed deadlines,
+                                             0 to always wait. */
+} sysd_daemon_registry_t;
+
+#define SYSD_DAEMON_FOR_EACH(DAEMON, REGISTRY)                      \
+    for ((DAEMON) = (REGISTRY)->daemons;                            \
+         (DAEMON) < (REGISTRY)->daemons + (REGISTRY)->n_daemons;    \
+         (DAEMON)++)
+
+extern sysd_daemon_registry_t daemon_registry;
+
+void sysd_daemon_registry_init(sysd_daemon_registry_t *reg);
+void sysd_daemon_registry_destroy(sysd_daemon_registry_t *reg);
+void sysd_daemon_registry_reserve(sysd_daemon_registry_t *reg, size_t n);
+daemon_info_t *sysd_daemon_registry_add(sysd_daemon_registry_t *reg,
+                                        const char *name);
+daemon_info_t *sysd_daemon_registry_find(const sysd_daemon_registry_t *reg,
+                                         const char *name);
+void sysd_daemon_registry_count_hw(sysd_daemon_registry_t *reg);
+void sysd_daemon_set_stage(sysd_daemon_registry_t *reg, daemon_info_t *daemon,
+                           const char *stage_name);
+void sysd_daemon_add_dependency(sysd_daemon_registry_t *reg,
+                                daemon_info_t *daemon, const char *name);
+int sysd_daemon_registry_build_graph(sysd_daemon_registry_t *reg);
+void sysd_daemon_registry_bind_rows(sysd_daemon_registry_t *reg,
+                                    const struct ovsdb_idl *idl);
+void sysd_daemon_registry_eval_ready(sysd_daemon_registry_t *reg);
+void sysd_daemon_registry_get_memory_usage(const sysd_daemon_registry_t *reg,
+                                           struct simap *usage);
+
+/** @} end of group ops-sysd */
+#endif /* __SYSD_DAEMON_H__ */
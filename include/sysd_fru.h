@@ -86,7 +86,9 @@ typedef struct fru_tlv {
     char            value[255];
 } fru_tlv_t;
 
-int sysd_read_fru_eeprom(fru_eeprom_t *fru_eeprom);
+struct sysd_arena;
+
+int sysd_read_fru_eeprom(fru_eeprom_t *fru_eeprom, struct sysd_arena *arena);
 
 /** @} end of group ops-sysd */
 #endif /* __SYSD_FRU_H__ */
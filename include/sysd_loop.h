@@ -0,0 +1,65 @@
+/************************************************************************//**
+ * (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *    License for the specific language governing permissions and limitations
+ *    under the License.
+ *
+ ***************************************************************************/
+/* @ingroup ops-sysd
+ *
+ * @file
+ * Header for ops-sysd main loop profiling.
+ */
+
+#ifndef __SYSD_LOOP_H__
+#define __SYSD_LOOP_H__
+
+/** @ingroup ops-sysd
+ * @{ */
+
+#include <stdbool.h>
+
+/* Number of main loop iterations kept for the rolling latency histogram. */
+#define SYSD_LOOP_HISTORY_LEN   1024
+
+/* Latency histogram buckets; bucket i counts [2^i, 2^(i+1)) usec and the
+ * last bucket everything above. */
+#define SYSD_LOOP_N_BUCKETS     21
+
+/* Handlers run by each main loop iteration. */
+enum sysd_loop_phase {
+    SYSD_LOOP_RUN,          /* sysd_run() */
+    SYSD_LOOP_UNIXCTL,      /* unixctl_server_run() */
+    SYSD_LOOP_WAIT,         /* sysd_wait() and unixctl_server_wait() */
+    SYSD_LOOP_N_PHASES
+};
+
+/* What woke the main loop, in increasing order of precedence. */
+enum sysd_loop_wake {
+    SYSD_WAKE_OTHER,        /* appctl or IDL traffic without a db change */
+    SYSD_WAKE_TIMER,        /* a readiness watchdog deadline */
+    SYSD_WAKE_DB,           /* the IDL seqno changed */
+    SYSD_WAKE_SPIN,         /* poll_block() skipped, see main() */
+    SYSD_WAKE_N_REASONS
+};
+
+struct ds;
+
+void sysd_loop_begin(void);
+void sysd_loop_phase_done(enum sysd_loop_phase phase);
+void sysd_loop_note_wake(enum sysd_loop_wake reason);
+void sysd_loop_end(bool spin);
+void sysd_loop_clear(void);
+void sysd_loop_dump(struct ds *ds);
+
+/** @} end of group ops-sysd */
+#endif /* __SYSD_LOOP_H__ */
@@ -0,0 +1,35 @@
+/************************************************************************//**
+ * (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *    License for the specific language governing permissions and limitations
+ *    under the License.
+ *
+ ***************************************************************************/
+/* @ingroup ops-sysd
+ *
+ * @file
+ * Header for the ops-sysd streaming image.manifest reader.
+ */
+
+#ifndef __SYSD_MANIFEST_H__
+#define __SYSD_MANIFEST_H__
+
+/** @ingroup ops-sysd
+ * @{ */
+
+#include <stdio.h>
+
+int sysd_manifest_read_file(const char *file_name);
+int sysd_manifest_read_stream(FILE *stream, const char *file_name);
+
+/** @} end of group ops-sysd */
+#endif /* __SYSD_MANIFEST_H__ */
@@ -26,12 +26,22 @@
 /** @ingroup ops-sysd
  * @{ */
 
+#include <stdbool.h>
+
 #define SYSD_MAC_FORMAT(a)	a[0], a[1], a[2], a[3], a[4], a[5]
 
+/* System:other_info key set to "true" once a readiness stage is ready. */
+#define SYSD_STAGE_READY_KEY_PREFIX "hw_ready_stage_"
+
 #define SYSD_OVS_PTR_CALLOC(OVS_STR, count)		\
 			(struct  OVS_STR *) calloc(sizeof(struct OVS_STR), count)
 
-void sysd_dump(char* buf, int buflen);
+struct ds;
+struct simap;
+
+char *sysd_dump(struct ds *ds, bool json, int n_sections,
+                const char *sections[]);
+void sysd_get_memory_usage(struct simap *usage);
 void sysd_run(void);
 void sysd_wait(void);
 
@@ -0,0 +1,66 @@
+/************************************************************************//**
+ * (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *    License for the specific language governing permissions and limitations
+ *    under the License.
+ *
+ ***************************************************************************/
+/* @ingroup ops-sysd
+ *
+ * @file
+ * Header for ops-sysd h/w daemon readiness tracking.
+ */
+
+#ifndef __SYSD_READINESS_H__
+#define __SYSD_READINESS_H__
+
+/** @ingroup ops-sysd
+ * @{ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "sysd_daemon.h"
+
+/* Number of boots for which each daemon's time-to-ready is kept. */
+#define SYSD_READINESS_HISTORY_LEN  32
+
+/* System:other_info key holding a daemon's time-to-ready in milliseconds. */
+#define SYSD_READY_MSEC_KEY_PREFIX  "hw_ready_msec_"
+
+/* System:other_info keys holding a daemon's p50/p99 time-to-ready over
+ * its history, in milliseconds. */
+#define SYSD_READY_P50_KEY_PREFIX   "hw_ready_p50_msec_"
+#define SYSD_READY_P99_KEY_PREFIX   "hw_ready_p99_msec_"
+
+/* System:other_info keys published by the readiness watchdog. */
+#define SYSD_HW_READINESS_KEY       "hw_readiness"
+#define SYSD_HW_LATE_DAEMONS_KEY    "hw_readiness_late_daemons"
+#define SYSD_HW_READINESS_READY     "ready"
+#define SYSD_HW_READINESS_DEGRADED  "degraded"
+
+struct ds;
+struct json;
+
+void sysd_readiness_init(void);
+long long int sysd_readiness_uptime_msec(void);
+void sysd_readiness_record(sysd_daemon_registry_t *reg);
+void sysd_readiness_watchdog_wait(const sysd_daemon_registry_t *reg);
+bool sysd_readiness_watchdog_run(sysd_daemon_registry_t *reg);
+bool sysd_readiness_percentiles(const char *name, long long int *p50,
+                                long long int *p99);
+size_t sysd_readiness_n_late(const sysd_daemon_registry_t *reg);
+void sysd_readiness_dump(struct ds *ds, const sysd_daemon_registry_t *reg);
+struct json *sysd_readiness_to_json(const sysd_daemon_registry_t *reg);
+
+/** @} end of group ops-sysd */
+#endif /* __SYSD_READINESS_H__ */
@@ -0,0 +1,49 @@
+/************************************************************************//**
+ * (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *    License for the specific language governing permissions and limitations
+ *    under the License.
+ *
+ ***************************************************************************/
+/* @ingroup ops-sysd
+ *
+ * @file
+ * Header for reconciling the database with the h/w description.
+ */
+
+#ifndef __SYSD_RECONCILE_H__
+#define __SYSD_RECONCILE_H__
+
+/** @ingroup ops-sysd
+ * @{ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct ovsdb_idl_txn;
+struct ovsrec_system;
+
+/*************************************************************************//**
+ * What a sysd_reconcile() pass wrote, for the log. Column writes made to
+ * rows inserted by the same pass are not counted as updates.
+ ****************************************************************************/
+struct sysd_reconcile_stats {
+    size_t      n_inserted;     /*!< Rows inserted. */
+    size_t      n_updated;      /*!< Columns rewritten on existing rows. */
+    size_t      n_removed;      /*!< Rows deleted or dropped. */
+};
+
+void sysd_reconcile(struct ovsdb_idl_txn *txn, struct ovsrec_system *sys,
+                    bool sys_created, struct sysd_reconcile_stats *stats);
+
+/** @} end of group ops-sysd */
+#endif /* __SYSD_RECONCILE_H__ */
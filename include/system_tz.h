@@ -0,0 +1,33 @@
+/* Local time conversion from tzfiles.
+ *
+ * Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * File: system_tz.h
+ *
+ * Purpose: To convert times to the local time of a zone other than the
+ *          process timezone, without changing TZ.
+ */
+
+#ifndef _SYSTEM_TZ_H
+#define _SYSTEM_TZ_H
+
+#include <stdbool.h>
+#include <time.h>
+
+bool system_tz_localtime(const char *path, time_t t, struct tm *tm);
+
+#endif /* _SYSTEM_TZ_H */
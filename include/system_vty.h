@@ -28,16 +28,24 @@
 #define SYS_STR	         "System information\n"
 #endif
 #define CLOCK_STR  "Shows system clock information\n"
+#define WATCH_STR  "Shows the system information, then the changes to it\n"
+#define WATCH_INTERVAL_STR  "Minimum interval between two updates\n"
+#ifndef JSON_STR
+#define JSON_STR  "Shows the output as one JSON document\n"
+#endif
 #define DATE_STR  "Shows system date information\n"
+#define CLOCK_ISO8601_STR "Shows the time in ISO 8601 format\n"
+#define CLOCK_HIGH_RES_STR "Shows the time in ISO 8601 format with nanoseconds\n"
 #define TIMEZONE_STR "Timezone information\n"
 #define TIMEZONE_SET_STR "Sets Timezone configuration\n"
-#define TIMEZONE_PLACEHOLDER_STR "Timezone Info\n"
+#define TIMEZONE_PLACEHOLDER_STR "Timezone name, such as us/pacific, or a unique prefix of one\n"
 #define DEFAULT_TIMEZONE "utc"
-#define MAX_TIMEZONES          900
+#define TIMEZONE_POSIX_DIR "/usr/share/zoneinfo/posix/"
 #define MAX_TIMEZONE_NAME_SIZE 100
-#define MAX_TIMEZONE_CMD_SIZE  (MAX_TIMEZONES*MAX_TIMEZONE_NAME_SIZE)
-#define MAX_TIMEZONE_HELP_SIZE 100
-#define MAX_TIMEZONES_HELP_SIZE  (MAX_TIMEZONES*MAX_TIMEZONE_HELP_SIZE)
+#define MAX_TIMEZONE_CANDIDATES 20
+
+/* Default minimum interval of "show system watch", in seconds. */
+#define SYSTEM_WATCH_DEFAULT_INTERVAL 1
 typedef enum
 {
         CLI_FAN,
@@ -51,10 +59,4 @@ int cli_system_get_all();
 void cli_pre_init(void);
 void cli_post_init(void);
 
-static int zone_count = 0;
-static char base_path[100] = "/usr/share/zoneinfo/posix/";
-char list_of_zones[MAX_TIMEZONES][MAX_TIMEZONE_NAME_SIZE];
-char list_of_zones_caps[MAX_TIMEZONES][MAX_TIMEZONE_NAME_SIZE];
-void find_posix_timezones_and_add_to_list(const char *name, int level, char *cmd, char *help);
-
 #endif //_SYSTEM_VTY_H
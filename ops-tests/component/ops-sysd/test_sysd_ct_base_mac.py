@@ -0,0 +1,108 @@
+# -*- coding: utf-8 -*-
+# (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+# All Rights Reserved.
+#
+#    Licensed under the Apache License, Version 2.0 (the "License"); you may
+#    not use this file except in compliance with the License. You may obtain
+#    a copy of the License at
+#
+#         http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing, software
+#    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+#    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+#    License for the specific language governing permissions and limitations
+#    under the License.
+#
+##########################################################################
+
+"""
+OpenSwitch Test for a stable system MAC across ops-sysd restarts.
+"""
+
+from pytest import mark
+from time import sleep
+
+TOPOLOGY = """
+# +-------+
+# |  ops1 |
+# +-------+
+
+# Nodes
+[type=openswitch name="OpenSwitch 1"] ops1
+"""
+
+
+ovs_vsctl = "/usr/bin/ovs-vsctl "
+ovs_appctl = "/usr/bin/ovs-appctl "
+ovsdb_tool = "/usr/bin/ovsdb-tool "
+
+base_mac_file = "/var/local/openswitch/ops-sysd/base_mac"
+
+
+def start(dut):
+    # Create an empty database file and load it into ovsdb-server.
+    dut(ovsdb_tool + "create /var/run/openvswitch/ovsdb.db "
+        "/usr/share/openvswitch/vswitch.ovsschema", shell="bash")
+    dut(ovs_appctl + "-t ovsdb-server ovsdb-server/add-db "
+        "/var/run/openvswitch/ovsdb.db", shell="bash")
+    sleep(3)
+    dut("/bin/systemctl start ops-sysd", shell="bash")
+    wait_until_ovsdb_is_up(dut)
+
+
+def stop(dut):
+    dut(ovs_appctl + "-t ops-sysd exit", shell="bash")
+    dut(ovs_appctl + "-t ovsdb-server ovsdb-server/remove-db OpenSwitch",
+        shell="bash")
+    dut("/bin/rm -f /var/run/openvswitch/ovsdb.db", shell="bash")
+    sleep(3)
+
+
+def wait_until_ovsdb_is_up(dut):
+    """Wait until System table is visible in the ovsdb-server."""
+    cmd = ovs_vsctl + "list System | grep uuid"
+    wait_count = 20
+    while wait_count > 0:
+        out = dut(cmd, shell="bash")
+        if "_uuid" in out:
+            break
+
+        wait_count -= 1
+        sleep(1)
+    assert wait_count != 0
+
+
+def get_system_mac(dut):
+    out = dut(ovs_vsctl + "--bare --columns=system_mac list System",
+              shell="bash")
+    return out.strip()
+
+
+@mark.gate
+@mark.platform_incompatible(['ostl'])
+def test_sysd_ct_base_mac_is_stable(topology, step):
+    ops1 = topology.get("ops1")
+    assert ops1 is not None
+
+    step("1-Read the system MAC assigned at boot")
+    first_mac = get_system_mac(ops1)
+    assert first_mac != ""
+
+    step("2-Restart ops-sysd against an empty database")
+    stop(ops1)
+    start(ops1)
+    assert get_system_mac(ops1) == first_mac
+
+    step("3-Drop the persisted base MAC, it is derived again")
+    stop(ops1)
+    ops1("/bin/rm -f " + base_mac_file, shell="bash")
+    start(ops1)
+    assert get_system_mac(ops1) == first_mac
+
+    step("4-A base MAC persisted for other fru.yaml inputs is not reused")
+    stop(ops1)
+    ops1("echo '02:00:00:00:00:01 00:00:00/0/stale-serial/stale-platform' > "
+         + base_mac_file, shell="bash")
+    start(ops1)
+    assert get_system_mac(ops1) == first_mac
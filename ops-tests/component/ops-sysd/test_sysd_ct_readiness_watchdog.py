@@ -0,0 +1,216 @@
+# -*- coding: utf-8 -*-
+# (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+# All Rights Reserved.
+#
+#    Licensed under the Apache License, Version 2.0 (the "License"); you may
+#    not use this file except in compliance with the License. You may obtain
+#    a copy of the License at
+#
+#         http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing, software
+#    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+#    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+#    License for the specific language governing permissions and limitations
+#    under the License.
+#
+##########################################################################
+
+"""
+OpenSwitch Test for the ops-sysd h/w daemon readiness watchdog.
+
+A fake h/w daemon, which never runs, is added to image.manifest with a
+short deadline. The test then plays the part of that daemon by setting
+its Daemon:cur_hw column by hand.
+"""
+
+from pytest import fixture, mark
+from time import sleep
+import json
+
+TOPOLOGY = """
+# +-------+
+# |  ops1 |
+# +-------+
+
+# Nodes
+[type=openswitch name="OpenSwitch 1"] ops1
+"""
+
+
+ovs_vsctl = "/usr/bin/ovs-vsctl "
+ovs_appctl = "/usr/bin/ovs-appctl "
+ovsdb_tool = "/usr/bin/ovsdb-tool "
+
+system_image_manifest_file = "/etc/openswitch/image.manifest"
+saved_image_manifest_file = "/tmp/image.manifest.orig"
+
+fake_daemon = "ops-fake-hwd"
+fake_daemon_timeout = 5
+
+watchdog_manifest = {
+    "daemons": {
+        "ops-sysd": {
+            "is_hw_handler": True
+        },
+        fake_daemon: {
+            "is_hw_handler": True,
+            "ready_timeout": fake_daemon_timeout
+        }
+    },
+    "readiness": {
+        "quorum": 1
+    },
+    "mgmt_intf": {
+        "intf": "eth0"
+    }
+}
+
+
+def start(dut):
+    # Create an empty database file and load it into ovsdb-server.
+    dut(ovsdb_tool + "create /var/run/openvswitch/ovsdb.db "
+        "/usr/share/openvswitch/vswitch.ovsschema", shell="bash")
+    dut(ovs_appctl + "-t ovsdb-server ovsdb-server/add-db "
+        "/var/run/openvswitch/ovsdb.db", shell="bash")
+    sleep(3)
+    dut("/bin/systemctl start ops-sysd", shell="bash")
+    wait_until_ovsdb_is_up(dut)
+
+
+def stop(dut):
+    dut(ovs_appctl + "-t ops-sysd exit", shell="bash")
+    dut(ovs_appctl + "-t ovsdb-server ovsdb-server/remove-db OpenSwitch",
+        shell="bash")
+    dut("/bin/rm -f /var/run/openvswitch/ovsdb.db", shell="bash")
+    sleep(3)
+
+
+def wait_until_ovsdb_is_up(dut):
+    """Wait until System table is visible in the ovsdb-server."""
+    cmd = ovs_vsctl + "list System | grep uuid"
+    wait_count = 20
+    while wait_count > 0:
+        out = dut(cmd, shell="bash")
+        if "_uuid" in out:
+            break
+
+        wait_count -= 1
+        sleep(1)
+    assert wait_count != 0
+
+
+def get_other_info(dut, key):
+    out = dut(ovs_vsctl + "--if-exists get System . other_info:" + key,
+              shell="bash")
+    return out.strip().strip('"')
+
+
+def get_cur_hw(dut):
+    out = dut(ovs_vsctl + "get System . cur_hw", shell="bash")
+    return out.strip()
+
+
+def get_next_hw(dut):
+    out = dut(ovs_vsctl + "get System . next_hw", shell="bash")
+    return out.strip()
+
+
+def wait_until_other_info(dut, key, value, wait_count=20):
+    """Wait until System:other_info:key is set to value."""
+    while wait_count > 0:
+        if get_other_info(dut, key) == value:
+            break
+
+        wait_count -= 1
+        sleep(1)
+    assert wait_count != 0
+
+
+def wait_until_cur_hw(dut, value, wait_count=20):
+    """Wait until System:cur_hw is set to value."""
+    while wait_count > 0:
+        if get_cur_hw(dut) == value:
+            break
+
+        wait_count -= 1
+        sleep(1)
+    assert wait_count != 0
+
+
+def wait_until_next_hw(dut, value, wait_count=20):
+    """Wait until System:next_hw is set to value."""
+    while wait_count > 0:
+        if get_next_hw(dut) == value:
+            break
+
+        wait_count -= 1
+        sleep(1)
+    assert wait_count != 0
+
+
+def set_daemon_cur_hw(dut, name, cur_hw):
+    uuid = dut(ovs_vsctl + "--bare --columns=_uuid find Daemon name=" + name,
+               shell="bash").strip()
+    dut(ovs_vsctl + "set Daemon " + uuid + " cur_hw=" + cur_hw, shell="bash")
+
+
+def set_daemon_ready(dut, name):
+    set_daemon_cur_hw(dut, name, "1")
+
+
+@fixture()
+def watchdog_setup(request, topology):
+    ops1 = topology.get("ops1")
+    assert ops1 is not None
+
+    stop(ops1)
+    ops1("/bin/cp " + system_image_manifest_file + " " +
+         saved_image_manifest_file, shell="bash")
+    ops1("echo '" + json.dumps(watchdog_manifest) + "' > " +
+         system_image_manifest_file, shell="bash")
+
+    def cleanup():
+        stop(ops1)
+        ops1("/bin/mv " + saved_image_manifest_file + " " +
+             system_image_manifest_file, shell="bash")
+        start(ops1)
+
+    request.addfinalizer(cleanup)
+
+
+@mark.gate
+@mark.platform_incompatible(['ostl'])
+def test_sysd_ct_readiness_watchdog(topology, step, watchdog_setup):
+    ops1 = topology.get("ops1")
+    assert ops1 is not None
+
+    step("1-Start ops-sysd with a h/w daemon that never becomes ready")
+    start(ops1)
+    assert get_cur_hw(ops1) == "0"
+    assert get_other_info(ops1, "hw_readiness") == ""
+
+    step("2-The deadline passes, the quorum of one lets cur_hw proceed")
+    wait_until_other_info(ops1, "hw_readiness", "degraded",
+                          fake_daemon_timeout + 15)
+    assert get_other_info(ops1, "hw_readiness_late_daemons") == fake_daemon
+    wait_until_cur_hw(ops1, "1")
+
+    out = ops1(ovs_appctl + "-t ops-sysd ops-sysd/readiness", shell="bash")
+    assert fake_daemon in out
+    assert "late" in out
+
+    step("3-The late daemon finally reports ready")
+    set_daemon_ready(ops1, fake_daemon)
+    wait_until_other_info(ops1, "hw_readiness", "ready")
+    assert get_other_info(ops1, "hw_readiness_late_daemons") == ""
+
+    step("4-The once late daemon re-initializes, cur_hw waits for it")
+    set_daemon_cur_hw(ops1, fake_daemon, "0")
+    wait_until_next_hw(ops1, "2")
+    assert get_cur_hw(ops1) == "1"
+
+    step("5-It is ready again, the new generation completes")
+    set_daemon_ready(ops1, fake_daemon)
+    wait_until_cur_hw(ops1, "2")
+    assert get_next_hw(ops1) == "2"
@@ -32,6 +32,47 @@ hs1:if01 -- sw1:if01
 """
 
 from pytest import mark
+import json
+import re
+
+
+def section_names(output, title):
+    # Names in the first column of a "show system" table, in display order.
+    lines = output.split('\n')
+    start = [i for i, line in enumerate(lines) if title in line][0]
+    names = []
+    in_rows = False
+    for line in lines[start + 1:]:
+        if line.startswith('---'):
+            in_rows = True
+        elif in_rows:
+            if not line.strip():
+                break
+            names.append(line.split()[0])
+    return names
+
+
+ISO8601_RE = (r'^\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}'
+              r'(\.\d{9})?([+-]\d{2}:\d{2})\s*$')
+
+
+def check_clock_formats(sw1, offset):
+    # Both commands, in both formats, in the configured zone.
+    for command in ['show system clock', 'show date']:
+        output = sw1(command + ' iso8601')
+        match = re.search(ISO8601_RE, output, re.MULTILINE)
+        assert match and match.group(1) is None, \
+            "Unexpected {} iso8601 output: {}\n".format(command, output)
+        assert match.group(2) == offset, \
+            "{} iso8601 is not in the configured timezone\n".format(command)
+        output = sw1(command + ' high-resolution')
+        match = re.search(ISO8601_RE, output, re.MULTILINE)
+        assert match and match.group(1) is not None, \
+            "Unexpected {} high-resolution output: {}\n".format(command,
+                                                                output)
+        assert match.group(2) == offset, \
+            "{} high-resolution is not in the configured timezone\n".format(
+                command)
 
 
 @mark.gate
@@ -145,3 +186,93 @@ def test_vtysh_ct_system(topology, step):  # noqa
     output = sw1('show running-config')
     assert "timezone set us/pacific" in output, \
         "Could not display configured system timezone us/pacific\n"
+    step("5-Test to verify timezone names in any case and unique prefixes")
+    sw1('configure terminal')
+    sw1('timezone set US/Eastern')
+    sw1('exit')
+    output = sw1('show system timezone')
+    assert "System is configured for timezone : US/Eastern" in output, \
+        "Could not configure system timezone in mixed case\n"
+    sw1('configure terminal')
+    sw1('timezone set us/pac')
+    sw1('exit')
+    output = sw1('show system timezone')
+    assert "System is configured for timezone : US/Pacific" in output, \
+        "Could not configure system timezone from a unique prefix\n"
+    step("6-Test to verify an ambiguous timezone prefix lists the zones")
+    sw1('configure terminal')
+    output = sw1('timezone set us/')
+    sw1('exit')
+    assert "Ambiguous timezone us/" in output, \
+        "Ambiguous timezone prefix was not reported\n"
+    assert "us/eastern" in output and "us/pacific" in output, \
+        "Ambiguous timezone prefix did not list the matching zones\n"
+    output = sw1('show system timezone')
+    assert "System is configured for timezone : US/Pacific" in output, \
+        "Ambiguous timezone prefix changed the system timezone\n"
+    step("7-Test to verify show system json matches show system")
+    # Added after the others and named to sort first, so insertion order
+    # and display order differ.
+    sw1('ovs-vsctl -- add Subsystem {uuid} fans @fan2 -- --id=@fan2 '
+        ' create fan name=Fan_aux speed=normal direction=f2b '
+        ' rpm=8000 status=ok'.format(**locals()),
+        shell='bash')
+    sw1('ovs-vsctl -- add Subsystem {uuid} power_supplies @psu2 -- '
+        ' --id=@psu2 create Power_supply name=Psu_aux '
+        ' status=ok'.format(**locals()),
+        shell='bash')
+    text = sw1('show system')
+    system = json.loads(sw1('show system json'))
+    fans = section_names(text, 'Fan details:')
+    psus = section_names(text, 'Power supply details:')
+    assert 'Fan_aux' in fans and fans == sorted(fans), \
+        "Fans are not sorted by name in show system\n"
+    assert 'Psu_aux' in psus and psus == sorted(psus), \
+        "Power supplies are not sorted by name in show system\n"
+    assert [fan['name'] for fan in system['fans']] == fans, \
+        "Fan order differs between show system json and show system\n"
+    assert [psu['name'] for psu in system['power_supplies']] == psus, \
+        "Power supply order differs between show system json and " \
+        "show system\n"
+    fan = [fan for fan in system['fans'] if fan['name'] == 'Fan_aux'][0]
+    assert fan['rpm'] == 8000, \
+        "Fan rpm is not a number in show system json\n"
+    step("8-Test to verify the iso8601 and high-resolution clock formats")
+    output = sw1('show system timezone')
+    offset = re.search(r'UTC offset\s*:\s*([+-]\d{2}:\d{2})', output)
+    assert offset and offset.group(1) in ['-07:00', '-08:00'], \
+        "Could not display the US/Pacific UTC offset\n"
+    check_clock_formats(sw1, offset.group(1))
+    sw1('configure terminal')
+    sw1('timezone set utc')
+    sw1('exit')
+    check_clock_formats(sw1, '+00:00')
+    step("9-Test to verify show system watch reports only the changes")
+    fan_uuid = sw1('ovs-vsctl --bare --columns=_uuid find fan name=Fan_aux',
+                   shell='bash').strip()
+    psu_uuid = sw1('ovs-vsctl --bare --columns=_uuid find power_supply '
+                   ' name=Psu_aux', shell='bash').strip()
+    # vtysh reads the terminal from the pipe: the final newline stops the
+    # watch once the changes had time to show up.
+    output = sw1('(sleep 2; ovs-vsctl set fan {fan_uuid} speed=fast; '
+                 ' ovs-vsctl remove Subsystem {uuid} power_supplies '
+                 ' {psu_uuid}; sleep 3; echo) | '
+                 ' vtysh -c "show system watch interval 1"'.format(**locals()),
+                 shell='bash')
+    assert "Fan details:" in output, \
+        "show system watch did not print the system first\n"
+    assert "Watching for changes every 1 second(s)" in output, \
+        "show system watch interval did not report its interval\n"
+    assert re.search(r'^\d{2}:\d{2}:\d{2} Fan\s+Fan_aux\s+fast\s+ok\s*$',
+                     output, re.MULTILINE), \
+        "show system watch did not report the changed fan\n"
+    assert re.search(r'^\d{2}:\d{2}:\d{2} PSU\s+Psu_aux\s+.*\(removed\)',
+                     output, re.MULTILINE), \
+        "show system watch did not report the removed power supply\n"
+    assert not re.search(r'^\d{2}:\d{2}:\d{2} (Fan\s+Fan_base|LED)',
+                         output, re.MULTILINE), \
+        "show system watch reported rows that did not change\n"
+    output = sw1('(sleep 1; echo) | vtysh -c "show system watch"',
+                 shell='bash')
+    assert "Watching for changes every 1 second(s)" in output, \
+        "show system watch did not use the default interval\n"
@@ -19,21 +19,20 @@ from opsvalidator import error
 from opsvalidator.error import ValidationError
 from opsrest.utils.utils import get_column_data_from_row
 
-import os
-from copy import copy
+# Generated at build time by src/cli/gen_timezones.py, shared with the CLI.
+TIMEZONE_INDEX = "/usr/share/ops-sysd/timezones"
+
 global list_of_timezones
 list_of_timezones = None
 
 
 def build_timezone_db():
     global list_of_timezones
-    path = "/usr/share/zoneinfo/posix/"
-    for root, directories, filenames in os.walk(path):
-        for filename in filenames:
-            full_path = os.path.join(root, filename)
-            timezone = copy(full_path)
-            timezone = timezone.replace(path, "")
-            list_of_timezones[timezone] = full_path
+    with open(TIMEZONE_INDEX) as index:
+        for line in index:
+            timezone = line.strip()
+            if timezone and not timezone.startswith("#"):
+                list_of_timezones.setdefault(timezone.lower(), timezone)
 
 
 def check_valid_timezone(timezone_user_input):
@@ -41,10 +40,8 @@ def check_valid_timezone(timezone_user_input):
     if list_of_timezones is None:
         list_of_timezones = {}
         build_timezone_db()
-    if timezone_user_input in list_of_timezones.keys():
-        return True
-    else:
-        return False
+    canonical = list_of_timezones.get(timezone_user_input.lower())
+    return canonical == timezone_user_input
 
 
 class SystemValidator(BaseValidator):
@@ -60,12 +60,15 @@ acl_init_limits(struct ovsdb_idl_txn *txn,
     snprintf(max_aces_str, ACL_LIMIT_BUFFER_SIZE, "%d", acl_info->max_aces);
     snprintf(max_aces_per_acl_str, ACL_LIMIT_BUFFER_SIZE, "%d", acl_info->max_aces_per_acl);
 
-    /* Store acl limitations in other_info column */
+    /* Store acl limitations in other_info column, unless they are already
+     * stored there */
     smap_clone(&smap, &system_row->other_info);
     smap_replace(&smap, ACL_LIMIT_KEY_MAX_ACLS, max_acls_str);
     smap_replace(&smap, ACL_LIMIT_KEY_MAX_ACES, max_aces_str);
     smap_replace(&smap, ACL_LIMIT_KEY_MAX_ACES_PER_ACL, max_aces_per_acl_str);
-    ovsrec_system_set_other_info(system_row, &smap);
+    if (!smap_equal(&smap, &system_row->other_info)) {
+        ovsrec_system_set_other_info(system_row, &smap);
+    }
     smap_destroy(&smap);
     return;
 }
@@ -0,0 +1,102 @@
+#!/usr/bin/env python
+# (C) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+#  Licensed under the Apache License, Version 2.0 (the "License"); you may
+#  not use this file except in compliance with the License. You may obtain
+#  a copy of the License at
+#
+#       http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+#  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+#  License for the specific language governing permissions and limitations
+#  under the License.
+
+"""Generates the timezone index and the CLI timezone catalog.
+
+The index lists every zone found under the posix zoneinfo directory, one
+canonical (mixed case) name per line, sorted by lower case name so readers
+can both hash and binary search it. Lines starting with '#' are comments.
+The REST validator loads it at run time.
+
+The catalog is a C header with the same zones as a string pool: the lower
+case and the canonical name of each zone, each NUL terminated, and the
+offset of every zone in the pool. The CLI plugin compiles it in, so vtysh
+does not read zoneinfo at startup.
+
+Usage: gen_timezones.py ZONEINFO_POSIX_DIR INDEX CATALOG
+"""
+
+import os
+import sys
+
+
+def find_zones(zoneinfo_dir):
+    zones = {}
+    # Newer tzdata ships posix/ as symlinks to the top level regions.
+    for root, directories, filenames in os.walk(zoneinfo_dir,
+                                                followlinks=True):
+        for filename in filenames:
+            zone = os.path.relpath(os.path.join(root, filename), zoneinfo_dir)
+            zone = zone.replace(os.sep, "/")
+            # Lookups are case insensitive; keep the first spelling seen.
+            zones.setdefault(zone.lower(), zone)
+    return [zones[key] for key in sorted(zones)]
+
+
+def write_index(zoneinfo_dir, zones, output):
+    with open(output, "w") as index:
+        index.write("# Generated by gen_timezones.py from %s, do not edit.\n"
+                    % zoneinfo_dir)
+        for zone in zones:
+            index.write(zone + "\n")
+
+
+def c_escape(string):
+    return string.replace("\\", "\\\\").replace('"', '\\"')
+
+
+def write_catalog_macro(catalog, name, literals):
+    catalog.write("#define %s \\\n" % name)
+    catalog.write(" \\\n".join("    " + literal for literal in literals))
+    catalog.write("\n\n")
+
+
+def write_catalog(zoneinfo_dir, zones, output):
+    pool, offsets, offset = [], [], 0
+    for zone in zones:
+        if offset > 0xffff:
+            raise ValueError("timezone pool offsets exceed 16 bits")
+        pool.append('"%s\\0" "%s\\0"' % (c_escape(zone.lower()),
+                                          c_escape(zone)))
+        offsets.append("%d," % offset)
+        offset += 2 * (len(zone) + 1)
+    with open(output, "w") as catalog:
+        catalog.write("/* Generated by gen_timezones.py from %s, do not edit."
+                      " */\n\n" % zoneinfo_dir)
+        catalog.write("#ifndef TIMEZONE_CATALOG_H\n"
+                      "#define TIMEZONE_CATALOG_H\n\n")
+        catalog.write("#define TIMEZONE_CATALOG_COUNT %d\n\n" % len(zones))
+        write_catalog_macro(catalog, "TIMEZONE_CATALOG_POOL", pool)
+        write_catalog_macro(catalog, "TIMEZONE_CATALOG_OFFSETS", offsets)
+        catalog.write("#endif /* TIMEZONE_CATALOG_H */\n")
+
+
+def main(argv):
+    if len(argv) != 4:
+        sys.stderr.write(__doc__)
+        return 1
+    zoneinfo_dir, output, catalog = argv[1], argv[2], argv[3]
+    zones = find_zones(zoneinfo_dir)
+    if not zones:
+        sys.stderr.write("%s: no timezones found in %s\n"
+                         % (argv[0], zoneinfo_dir))
+        return 1
+    write_index(zoneinfo_dir, zones, output)
+    write_catalog(zoneinfo_dir, zones, catalog)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,535 @@
+/* Local time conversion from tzfiles.
+ *
+ * Copyright (C) 2016 Hewlett Packard Enterprise Development LP
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * File: system_tz.c
+ *
+ * Purpose:  To convert times to the local time of the zone configured in the
+ *           System table. The zone's tzfile (RFC 8536) is read directly, so
+ *           the conversion neither changes TZ nor calls tzset(), which would
+ *           race with the other vtysh threads using the process timezone.
+ */
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "util.h"
+#include "system_tz.h"
+
+/* Largest tzfile accepted; the biggest posix zones are a few kB. */
+#define TZ_FILE_MAX (256 * 1024)
+
+#define TZ_HEADER_LEN 44
+#define TZ_ABBR_MAX 16
+
+/* Local time type, the "ttinfo" of a tzfile. */
+struct tz_type {
+    int32_t utoff;              /* Seconds east of UTC. */
+    bool isdst;
+    uint8_t abbr;               /* Offset in tz_info.abbrs. */
+};
+
+/* Transition date of a POSIX TZ rule. */
+struct tz_date {
+    char kind;                  /* 'J' Julian day, 'N' zero-based day, 'M'. */
+    int n;                      /* Day for 'J' and 'N', month for 'M'. */
+    int week;                   /* 'M' only: 1-5, 5 is the last. */
+    int wday;                   /* 'M' only: 0 is Sunday. */
+    int32_t secs;               /* Local time of day of the transition. */
+};
+
+/* POSIX TZ rule from the tzfile footer, for times after the last
+ * transition. */
+struct tz_rule {
+    bool valid;
+    bool has_dst;
+    int32_t std_off, dst_off;   /* Seconds east of UTC. */
+    char std_abbr[TZ_ABBR_MAX];
+    char dst_abbr[TZ_ABBR_MAX];
+    struct tz_date start, end;
+};
+
+/* The parsed tzfile of one zone. */
+struct tz_info {
+    char *path;
+    int64_t *times;             /* Transition times, ascending. */
+    uint8_t *type_of;           /* Local time type after each transition. */
+    size_t n_times;
+    struct tz_type *types;
+    size_t n_types;
+    char *abbrs;                /* NUL terminated abbreviations. */
+    size_t n_abbrs;
+    struct tz_rule rule;
+};
+
+/* Zone of the last conversion. The CLI reads the same zone for every
+ * command, so the file is read again only when the configured zone
+ * changes. Only command handlers use it, and they run one at a time. */
+static struct tz_info tz_cache;
+
+static uint32_t
+tz_get32(const uint8_t *p)
+{
+    return ((uint32_t) p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static int64_t
+tz_get64(const uint8_t *p)
+{
+    return (int64_t) (((uint64_t) tz_get32(p) << 32) | tz_get32(p + 4));
+}
+
+static void
+tz_info_clear(struct tz_info *tz)
+{
+    free(tz->path);
+    free(tz->times);
+    free(tz->type_of);
+    free(tz->types);
+    free(tz->abbrs);
+    memset(tz, 0, sizeof *tz);
+}
+
+/* Days from 1970-01-01 to 'year'-'month'-'day' in the proleptic Gregorian
+ * calendar. */
+static int64_t
+tz_days_from_civil(int64_t year, int month, int day)
+{
+    int64_t era, yoe, doy;
+
+    year -= month <= 2;
+    era = (year >= 0 ? year : year - 399) / 400;
+    yoe = year - era * 400;
+    doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    return era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy - 719468;
+}
+
+static bool
+tz_is_leap(int64_t year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+/* Parses the abbreviation at 's' into 'abbr'. Returns the end of the
+ * abbreviation, or NULL if it is not valid. */
+static const char *
+tz_parse_abbr(const char *s, char *abbr)
+{
+    const char *start;
+    size_t n;
+
+    if (*s == '<') {
+        start = ++s;
+        while (*s && *s != '>') {
+            s++;
+        }
+        if (*s != '>') {
+            return NULL;
+        }
+        n = s++ - start;
+    } else {
+        start = s;
+        while (isalpha((unsigned char) *s)) {
+            s++;
+        }
+        n = s - start;
+    }
+    if (n < 3 || n >= TZ_ABBR_MAX) {
+        return NULL;
+    }
+    memcpy(abbr, start, n);
+    abbr[n] = '\0';
+    return s;
+}
+
+/* Parses "[+|-]hh[:mm[:ss]]" at 's' into 'secs'. Returns the end of the
+ * time, or NULL if it is not valid. */
+static const char *
+tz_parse_secs(const char *s, int32_t *secs)
+{
+    int sign = 1, field = 0, value[3] = { 0, 0, 0 };
+
+    if (*s == '+' || *s == '-') {
+        sign = *s++ == '-' ? -1 : 1;
+    }
+    for (;;) {
+        if (!isdigit((unsigned char) *s)) {
+            return NULL;
+        }
+        while (isdigit((unsigned char) *s) && value[field] < 1000) {
+            value[field] = value[field] * 10 + (*s++ - '0');
+        }
+        if (*s != ':' || ++field == 3) {
+            break;
+        }
+        s++;
+    }
+    *secs = sign * (value[0] * 3600 + value[1] * 60 + value[2]);
+    return s;
+}
+
+/* Parses a ",date[/time]" transition of a POSIX TZ rule at 's'. */
+static const char *
+tz_parse_date(const char *s, struct tz_date *date)
+{
+    char *end;
+
+    if (*s++ != ',') {
+        return NULL;
+    }
+    if (*s == 'M') {
+        date->kind = 'M';
+        date->n = strtol(s + 1, &end, 10);
+        if (*end != '.' || date->n < 1 || date->n > 12) {
+            return NULL;
+        }
+        date->week = strtol(end + 1, &end, 10);
+        if (*end != '.' || date->week < 1 || date->week > 5) {
+            return NULL;
+        }
+        date->wday = strtol(end + 1, &end, 10);
+        if (date->wday < 0 || date->wday > 6) {
+            return NULL;
+        }
+    } else {
+        date->kind = *s == 'J' ? 'J' : 'N';
+        s += *s == 'J';
+        if (!isdigit((unsigned char) *s)) {
+            return NULL;
+        }
+        date->n = strtol(s, &end, 10);
+        if (date->n > 365 || (date->kind == 'J' && date->n < 1)) {
+            return NULL;
+        }
+    }
+    s = end;
+
+    date->secs = 2 * 3600;
+    if (*s == '/') {
+        s = tz_parse_secs(s + 1, &date->secs);
+    }
+    return s;
+}
+
+/* Parses the POSIX TZ rule 'spec', such as "PST8PDT,M3.2.0,M11.1.0". */
+static bool
+tz_parse_rule(const char *spec, struct tz_rule *rule)
+{
+    const char *s = spec;
+    int32_t off;
+
+    memset(rule, 0, sizeof *rule);
+    s = tz_parse_abbr(s, rule->std_abbr);
+    s = s ? tz_parse_secs(s, &off) : NULL;
+    if (!s) {
+        return false;
+    }
+    /* POSIX offsets are west of UTC. */
+    rule->std_off = -off;
+
+    if (*s) {
+        s = tz_parse_abbr(s, rule->dst_abbr);
+        if (!s) {
+            return false;
+        }
+        rule->has_dst = true;
+        rule->dst_off = rule->std_off + 3600;
+        if (*s && *s != ',') {
+            s = tz_parse_secs(s, &off);
+            if (!s) {
+                return false;
+            }
+            rule->dst_off = -off;
+        }
+        if (*s) {
+            s = tz_parse_date(s, &rule->start);
+            s = s ? tz_parse_date(s, &rule->end) : NULL;
+        } else {
+            /* No rule, POSIX leaves it to the implementation. Use the
+             * US rules like glibc does. */
+            s = tz_parse_date(",M3.2.0", &rule->start);
+            s = tz_parse_date(",M11.1.0", &rule->end);
+        }
+        if (!s || *s) {
+            return false;
+        }
+    }
+    rule->valid = true;
+    return true;
+}
+
+/* Returns the local time, as seconds since the epoch, at which 'date' falls
+ * in 'year'. */
+static int64_t
+tz_date_time(const struct tz_date *date, int64_t year)
+{
+    static const int month_days[] = {
+        31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+    };
+    int64_t day;
+
+    if (date->kind == 'M') {
+        int days = month_days[date->n - 1] + (date->n == 2 && tz_is_leap(year));
+        int64_t first = tz_days_from_civil(year, date->n, 1);
+        /* 1970-01-01 was a Thursday. */
+        int first_wday = ((first + 4) % 7 + 7) % 7;
+        int mday = 1 + (date->wday - first_wday + 7) % 7
+                   + (date->week - 1) * 7;
+
+        while (mday > days) {
+            mday -= 7;
+        }
+        day = first + mday - 1;
+    } else if (date->kind == 'J') {
+        /* Julian days never count February 29. */
+        day = tz_days_from_civil(year, 1, 1) + date->n - 1
+              + (tz_is_leap(year) && date->n >= 60);
+    } else {
+        day = tz_days_from_civil(year, 1, 1) + date->n;
+    }
+    return day * 86400 + date->secs;
+}
+
+/* Applies 'rule' to 't'. */
+static void
+tz_rule_lookup(const struct tz_rule *rule, int64_t t, int32_t *utoff,
+               bool *isdst, const char **abbr)
+{
+    int64_t start, end;
+    time_t local;
+    struct tm tm;
+    bool dst;
+
+    if (!rule->has_dst) {
+        *utoff = rule->std_off;
+        *isdst = false;
+        *abbr = rule->std_abbr;
+        return;
+    }
+
+    local = t + rule->std_off;
+    gmtime_r(&local, &tm);
+    /* DST starts in standard time and ends in daylight time. */
+    start = tz_date_time(&rule->start, tm.tm_year + 1900LL) - rule->std_off;
+    end = tz_date_time(&rule->end, tm.tm_year + 1900LL) - rule->dst_off;
+    if (start < end) {
+        dst = t >= start && t < end;
+    } else {
+        /* Southern hemisphere, DST spans the new year. */
+        dst = !(t >= end && t < start);
+    }
+
+    *utoff = dst ? rule->dst_off : rule->std_off;
+    *isdst = dst;
+    *abbr = dst ? rule->dst_abbr : rule->std_abbr;
+}
+
+/* Looks up the local time type of 't' in 'tz'. */
+static void
+tz_lookup(const struct tz_info *tz, int64_t t, int32_t *utoff, bool *isdst,
+          const char **abbr)
+{
+    const struct tz_type *type;
+    size_t low, high;
+
+    if (tz->rule.valid && (!tz->n_times || t >= tz->times[tz->n_times - 1])) {
+        tz_rule_lookup(&tz->rule, t, utoff, isdst, abbr);
+        return;
+    }
+
+    if (!tz->n_times || t < tz->times[0]) {
+        /* Times before the first transition use the first type. */
+        type = &tz->types[0];
+    } else {
+        /* Last transition at or before 't'. */
+        low = 0;
+        high = tz->n_times;
+        while (high - low > 1) {
+            size_t mid = low + (high - low) / 2;
+
+            if (tz->times[mid] <= t) {
+                low = mid;
+            } else {
+                high = mid;
+            }
+        }
+        type = &tz->types[tz->type_of[low]];
+    }
+
+    *utoff = type->utoff;
+    *isdst = type->isdst;
+    *abbr = &tz->abbrs[type->abbr];
+}
+
+/* Reads the counts of the tzfile header at 'p' and returns the size of the
+ * data block that follows it, with 'time_size' byte times. */
+static size_t
+tz_block_size(const uint8_t *p, size_t time_size, uint32_t counts[6])
+{
+    int i;
+
+    for (i = 0; i < 6; i++) {
+        counts[i] = tz_get32(p + 20 + 4 * i);
+        if (counts[i] > TZ_FILE_MAX) {
+            return SIZE_MAX;
+        }
+    }
+    /* isutcnt, isstdcnt, leapcnt, timecnt, typecnt, charcnt. */
+    return counts[3] * (time_size + 1) + counts[4] * 6 + counts[5]
+           + counts[2] * (time_size + 4) + counts[1] + counts[0];
+}
+
+/* Parses the tzfile in 'buf' into 'tz'. */
+static bool
+tz_parse(const uint8_t *buf, size_t len, struct tz_info *tz)
+{
+    const uint8_t *p = buf, *end = buf + len;
+    size_t time_size = 4, size, i;
+    uint32_t counts[6];
+
+    if (len < TZ_HEADER_LEN || memcmp(p, "TZif", 4)) {
+        return false;
+    }
+    size = tz_block_size(p, time_size, counts);
+    if (p[4] >= '2') {
+        /* Version 2 and later repeat the data with 64-bit times. */
+        p += TZ_HEADER_LEN + size;
+        if (size == SIZE_MAX || end - p < TZ_HEADER_LEN
+            || memcmp(p, "TZif", 4)) {
+            return false;
+        }
+        time_size = 8;
+        size = tz_block_size(p, time_size, counts);
+    }
+    if (size == SIZE_MAX || end - p - TZ_HEADER_LEN < size
+        || !counts[4] || counts[4] > 256) {
+        return false;
+    }
+    p += TZ_HEADER_LEN;
+
+    tz->n_times = counts[3];
+    tz->times = xmalloc(MAX(tz->n_times, 1) * sizeof *tz->times);
+    for (i = 0; i < tz->n_times; i++, p += time_size) {
+        tz->times[i] = time_size == 8 ? tz_get64(p) : (int32_t) tz_get32(p);
+    }
+    tz->type_of = xmalloc(MAX(tz->n_times, 1));
+    for (i = 0; i < tz->n_times; i++, p++) {
+        if (*p >= counts[4]) {
+            return false;
+        }
+        tz->type_of[i] = *p;
+    }
+
+    tz->n_types = counts[4];
+    tz->types = xmalloc(tz->n_types * sizeof *tz->types);
+    for (i = 0; i < tz->n_types; i++, p += 6) {
+        tz->types[i].utoff = (int32_t) tz_get32(p);
+        tz->types[i].isdst = p[4];
+        tz->types[i].abbr = p[5];
+        if (p[5] >= counts[5]) {
+            return false;
+        }
+    }
+
+    tz->n_abbrs = counts[5];
+    tz->abbrs = xmalloc(tz->n_abbrs + 1);
+    memcpy(tz->abbrs, p, tz->n_abbrs);
+    tz->abbrs[tz->n_abbrs] = '\0';
+    p += tz->n_abbrs;
+
+    /* The leap seconds and the standard/UT indicators are not needed:
+     * posix zones have no leap seconds. */
+    p += counts[2] * (time_size + 4) + counts[1] + counts[0];
+
+    /* Version 2 and later end with a POSIX TZ rule between newlines. An
+     * empty or bad rule leaves the last transition in force. */
+    if (time_size == 8 && p < end && *p == '\n') {
+        const uint8_t *nl = memchr(p + 1, '\n', end - p - 1);
+
+        if (nl) {
+            char *spec = xmemdup0((const char *) p + 1, nl - p - 1);
+
+            tz_parse_rule(spec, &tz->rule);
+            free(spec);
+        }
+    }
+    return true;
+}
+
+/* Reads the tzfile at 'path' into 'tz'. */
+static bool
+tz_load(const char *path, struct tz_info *tz)
+{
+    uint8_t *buf;
+    size_t len;
+    bool ok;
+    FILE *f;
+
+    f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    buf = xmalloc(TZ_FILE_MAX);
+    len = fread(buf, 1, TZ_FILE_MAX, f);
+    ok = !ferror(f) && len < TZ_FILE_MAX && tz_parse(buf, len, tz);
+    fclose(f);
+    free(buf);
+
+    if (!ok) {
+        tz_info_clear(tz);
+        return false;
+    }
+    tz->path = xstrdup(path);
+    return true;
+}
+
+/*
+ * Function        : system_tz_localtime
+ * Resposibility   : Converts a time to the local time of the zone in the
+ *                   tzfile at 'path', like localtime_r() with TZ set to the
+ *                   zone but without changing the process timezone.
+ *                   tm_zone points to storage that is valid until the next
+ *                   call for another zone
+ * Return          : Returns false if the tzfile cannot be read
+ */
+bool
+system_tz_localtime(const char *path, time_t t, struct tm *tm)
+{
+    const char *abbr;
+    time_t local;
+    int32_t utoff;
+    bool isdst;
+
+    if (!tz_cache.path || strcmp(tz_cache.path, path)) {
+        tz_info_clear(&tz_cache);
+        if (!tz_load(path, &tz_cache)) {
+            return false;
+        }
+    }
+
+    tz_lookup(&tz_cache, t, &utoff, &isdst, &abbr);
+    local = t + utoff;
+    if (!gmtime_r(&local, tm)) {
+        return false;
+    }
+    tm->tm_isdst = isdst;
+    tm->tm_gmtoff = utoff;
+    tm->tm_zone = abbr;
+    return true;
+}
@@ -27,34 +27,93 @@
 #include "vtysh/vtysh.h"
 #include "vtysh/vtysh_user.h"
 #include "system_vty.h"
+#include "system_tz.h"
 #include "vswitch-idl.h"
 #include "ovsdb-idl.h"
 #include "smap.h"
+#include "dynamic-string.h"
+#include "hash.h"
+#include "shash.h"
+#include "uuid.h"
+#include "hmap.h"
+#include "poll-loop.h"
+#include "timeval.h"
+#include "util.h"
 #include "vtysh/memory.h"
 #include "openvswitch/vlog.h"
 #include "openswitch-idl.h"
 #include "vtysh/vtysh_ovsdb_if.h"
 #include "vtysh/vtysh_ovsdb_config.h"
 #include "vtysh/utils/system_vtysh_utils.h"
-#include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <ctype.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <readline/readline.h>
 #include "vtysh_ovsdb_system_context.h"
+#include "timezone_catalog.h"
 
 VLOG_DEFINE_THIS_MODULE(vtysh_system_cli);
 
 extern struct ovsdb_idl *idl;
+
+/*
+ * Sorted row pointers of a table, kept between invocations of
+ * "show system" and rebuilt only when the IDL seqno moves.
+ */
+struct cli_row_index {
+    const void **rows;
+    size_t n;
+    size_t allocated;
+};
+
+/* Sections of the "show system" output, each rendered into one buffer. */
+enum cli_system_section {
+    CLI_SYSTEM_SECTION_INFO,
+    CLI_SYSTEM_SECTION_FAN,
+    CLI_SYSTEM_SECTION_LED,
+    CLI_SYSTEM_SECTION_PSU,
+    CLI_SYSTEM_SECTION_TEMP,
+    CLI_SYSTEM_N_SECTIONS
+};
+
+static struct cli_system_cache {
+    bool valid;
+    unsigned int seqno;             /* IDL seqno the cache was built at. */
+    const char *newline;            /* VTY_NEWLINE the text was built with. */
+    struct cli_row_index fans;      /* By name. */
+    struct cli_row_index psus;      /* By name. */
+    struct ds sections[CLI_SYSTEM_N_SECTIONS];
+    bool json_valid;                /* 'json' matches 'seqno'. */
+    struct ds json;                 /* "show system json" document. */
+} system_cache;
+
+/*
+ * Streaming JSON writer for "show system json": members are appended to
+ * 'ds' as they are visited, without building a json tree first.
+ */
+struct cli_json {
+    struct ds *ds;
+    bool first;                     /* Nothing written in this container. */
+};
+
 /*
  * Function        : compare_fan
  * Resposibility     : Fan sort function for qsort
  * Parameters
- *  a   : Pointer to 1st element in the array
- *  b   : Pointer to next element in the array
+ *  a   : Pointer to 1st element in the array of row pointers
+ *  b   : Pointer to next element in the array of row pointers
  * Return      : comparative difference between names.
  */
 static inline int
 compare_fan (const void* a,const void* b)
 {
-    struct ovsrec_fan* s1 = (struct ovsrec_fan*)a;
-    struct ovsrec_fan* s2 = (struct ovsrec_fan*)b;
+    const struct ovsrec_fan* s1 = *(const struct ovsrec_fan* const*)a;
+    const struct ovsrec_fan* s2 = *(const struct ovsrec_fan* const*)b;
 
     return (strcmp(s1->name,s2->name));
 }
@@ -63,19 +122,38 @@ compare_fan (const void* a,const void* b)
  * Function        : compare_psu
  * Resposibility    : Power Supply sort function for qsort
  * Parameters
- *   a   : Pointer to 1st element in the array
- *   b   : Pointer to next element in the array
+ *   a   : Pointer to 1st element in the array of row pointers
+ *   b   : Pointer to next element in the array of row pointers
  * Return      : comparative difference between names.
  */
 static inline int
 compare_psu(const void* a,const void* b)
 {
-    struct ovsrec_power_supply* s1 = (struct ovsrec_power_supply*)a;
-    struct ovsrec_power_supply* s2 = (struct ovsrec_power_supply*)b;
+    const struct ovsrec_power_supply* s1 =
+        *(const struct ovsrec_power_supply* const*)a;
+    const struct ovsrec_power_supply* s2 =
+        *(const struct ovsrec_power_supply* const*)b;
 
     return (strcmp(s1->name,s2->name));
 }
 
+/*
+ * Function        : cli_row_index_add
+ * Resposibility     : Appends a row pointer to a row index
+ * Parameters
+ *  index   : Pointer to the row index
+ *  row     : Pointer to the IDL row
+ */
+static void
+cli_row_index_add(struct cli_row_index *index, const void *row)
+{
+    if (index->n >= index->allocated) {
+        index->rows = x2nrealloc(index->rows, &index->allocated,
+                                 sizeof *index->rows);
+    }
+    index->rows[index->n++] = row;
+}
+
 /*
  * Function        : format_psu_string
  * Resposibility     : Change status string in OVSDB to more
@@ -104,262 +182,708 @@ format_psu_string (char* status)
     return status;
 }
 
+/*
+ * Function        : other_info_string
+ * Resposibility     : Looks up a subsystem other_info value for display
+ * Parameters
+ *  pSys    : Pointer to ovsrec_subsystem structure
+ *  key     : other_info key
+ * Return      : The value, or " " when the key is not set.
+ */
+static const char*
+other_info_string (const struct ovsrec_subsystem* pSys, const char* key)
+{
+    const char* buf = smap_get (&pSys->other_info, key);
+
+    return (buf) ? buf : " ";
+}
+
 /*
  * Function        : format_sys_output
- * Resposibility     : Format and Print output for system info
+ * Resposibility     : Format the output for system info
  * Parameters
- *      vty : Pointer to vty structure
+ *      ds  : Buffer to render into
  *  pSys    : Pointer to ovsrec_subsystem structure
  *  pVswitch: Pointer to ovsrec_system structure
+ *      nl  : Newline of the vty
  */
 static void
-format_sys_output (struct vty* vty,
+format_sys_output (struct ds* ds,
                 const struct ovsrec_subsystem* pSys,
-                const struct ovsrec_system* pVswitch)
+                const struct ovsrec_system* pVswitch,
+                const char* nl)
 {
-    const char* buf = NULL;
-    vty_out(vty, "%-20s%s%-30s%s", "OpenSwitch Version", ": ",
-                 (pVswitch->switch_version) ? pVswitch->switch_version : " ",
-                 VTY_NEWLINE);
-
-    buf = smap_get (&pSys->other_info,"Product Name");
-    (buf) ? vty_out(vty,"%-20s%s%-30s%s%s",
-            "Product Name",": ",buf,VTY_NEWLINE,VTY_NEWLINE):\
-        vty_out(vty,"%-20s%s%-30s%s%s",
-                "Product Name",": "," ",VTY_NEWLINE,VTY_NEWLINE);
+    ds_put_format(ds, "%-20s%s%-30s%s", "OpenSwitch Version", ": ",
+                  (pVswitch->switch_version) ? pVswitch->switch_version : " ",
+                  nl);
+    ds_put_format(ds, "%-20s%s%-30s%s%s", "Product Name", ": ",
+                  other_info_string(pSys, "Product Name"), nl, nl);
+
+    ds_put_format(ds, "%-20s%s%-30s%s", "Vendor", ": ",
+                  other_info_string(pSys, "vendor"), nl);
+    ds_put_format(ds, "%-20s%s%-30s%s", "Platform", ": ",
+                  other_info_string(pSys, "platform_name"), nl);
+    ds_put_format(ds, "%-20s%s%-20s%s", "Manufacturer", ": ",
+                  other_info_string(pSys, "manufacturer"), nl);
+    ds_put_format(ds, "%-20s%s%-20s%s%s", "Manufacturer Date", ": ",
+                  other_info_string(pSys, "manufacture_date"), nl, nl);
+
+    ds_put_format(ds, "%-20s%s%-20s", "Serial Number", ": ",
+                  other_info_string(pSys, "serial_number"));
+    ds_put_format(ds, "%-20s%s%-10s%s%s", "Label Revision", ": ",
+                  other_info_string(pSys, "label_revision"), nl, nl);
+
+    ds_put_format(ds, "%-20s%s%-20s", "ONIE Version", ": ",
+                  other_info_string(pSys, "onie_version"));
+    ds_put_format(ds, "%-20s%s%-10s%s", "DIAG Version", ": ",
+                  other_info_string(pSys, "diag_version"), nl);
+    ds_put_format(ds, "%-20s%s%-20s", "Base MAC Address", ": ",
+                  other_info_string(pSys, "base_mac_address"));
+    ds_put_format(ds, "%-20s%s%-5s%s", "Number of MACs", ": ",
+                  other_info_string(pSys, "number_of_macs"), nl);
+    ds_put_format(ds, "%-20s%s%-20s", "Interface Count", ": ",
+                  other_info_string(pSys, "interface_count"));
+    ds_put_format(ds, "%-20s%s%-6sMbps%s", "Max Interface Speed", ": ",
+                  other_info_string(pSys, "max_interface_speed"), nl);
+}
 
-    buf = smap_get (&pSys->other_info,"vendor");
-    (buf) ? vty_out(vty,"%-20s%s%-30s%s","Vendor",": ", buf, VTY_NEWLINE):\
-        vty_out(vty,"%-20s%s%-30s%s","Vendor",": "," ", VTY_NEWLINE);
+/*
+ * Function        : cli_json_put_string
+ * Resposibility     : Writes a JSON string literal, or null for NULL
+ */
+static void
+cli_json_put_string(struct ds *ds, const char *s)
+{
+    if (!s) {
+        ds_put_cstr(ds, "null");
+        return;
+    }
 
-    buf = smap_get (&pSys->other_info,"platform_name");
-    (buf) ? vty_out(vty,"%-20s%s%-30s%s","Platform",": ", buf, VTY_NEWLINE):\
-        vty_out(vty,"%-20s%s%-30s%s","Platform",": "," ", VTY_NEWLINE);
+    ds_put_char(ds, '"');
+    for (; *s; s++) {
+        unsigned char c = *s;
 
-    buf = smap_get (&pSys->other_info,"manufacturer");
-    (buf) ? vty_out(vty,"%-20s%s%-20s%s","Manufacturer",": ",buf,VTY_NEWLINE):\
-        vty_out(vty,"%-20s%s%-20s%s","Manufacturer",": "," ", VTY_NEWLINE);
+        if (c == '"' || c == '\\') {
+            ds_put_char(ds, '\\');
+            ds_put_char(ds, c);
+        } else if (c < 0x20) {
+            ds_put_format(ds, "\\u%04x", c);
+        } else {
+            ds_put_char(ds, c);
+        }
+    }
+    ds_put_char(ds, '"');
+}
 
-    buf = smap_get (&pSys->other_info,"manufacture_date");
-    (buf) ? vty_out(vty,"%-20s%s%-20s%s%s",
-            "Manufacturer Date",": ", buf, VTY_NEWLINE, VTY_NEWLINE):\
-        vty_out(vty,"%-20s%s%-20s%s%s",
-                "Manufacturer Date",": "," ", VTY_NEWLINE, VTY_NEWLINE);
+/*
+ * Function        : cli_json_member
+ * Resposibility     : Starts a JSON value: writes the separator and, inside
+ *        an object, the member name
+ * Parameters
+ *  json    : Pointer to the JSON writer
+ *  name    : Member name, or NULL inside an array
+ */
+static void
+cli_json_member(struct cli_json *json, const char *name)
+{
+    if (!json->first) {
+        ds_put_char(json->ds, ',');
+    }
+    json->first = false;
+    if (name) {
+        cli_json_put_string(json->ds, name);
+        ds_put_char(json->ds, ':');
+    }
+}
 
+/* Opens an object or array, 'open' being '{' or '['. */
+static void
+cli_json_open(struct cli_json *json, const char *name, char open)
+{
+    cli_json_member(json, name);
+    ds_put_char(json->ds, open);
+    json->first = true;
+}
 
-    buf = smap_get (&pSys->other_info,"serial_number");
-    (buf) ? vty_out(vty,"%-20s%s%-20s","Serial Number",": ", buf):\
-        vty_out(vty,"%-20s%s%-20s","Serial Number",": "," ");
+/* Closes an object or array, 'close' being '}' or ']'. */
+static void
+cli_json_close(struct cli_json *json, char close)
+{
+    ds_put_char(json->ds, close);
+    json->first = false;
+}
 
-    buf = smap_get (&pSys->other_info,"label_revision");
-    (buf) ? vty_out(vty,"%-20s%s%-10s%s%s",
-            "Label Revision",": ", buf, VTY_NEWLINE,VTY_NEWLINE):\
-        vty_out(vty,"%-20s%s%-10s%s%s",
-                "Label Revision",": "," ", VTY_NEWLINE,VTY_NEWLINE);
+static void
+cli_json_string(struct cli_json *json, const char *name, const char *value)
+{
+    cli_json_member(json, name);
+    cli_json_put_string(json->ds, value);
+}
 
+/*
+ * Function        : format_sys_json
+ * Resposibility     : Renders "show system" as one JSON document, in a single
+ *        pass over the same rows and in the same order as the text output
+ * Parameters
+ *      ds  : Buffer to render into
+ *  cache   : Pointer to the refreshed show system cache
+ */
+static void
+format_sys_json (struct ds* ds, const struct cli_system_cache* cache)
+{
+    struct cli_json json = { ds, true };
+    const struct ovsrec_subsystem* pSys = ovsrec_subsystem_first(idl);
+    const struct ovsrec_system* pVswitch = ovsrec_system_first(idl);
+    const struct ovsrec_led* pLed = NULL;
+    const struct ovsrec_temp_sensor* pTempSen = NULL;
+    size_t i;
 
-    buf = smap_get (&pSys->other_info,"onie_version");
-    (buf) ? vty_out(vty,"%-20s%s%-20s","ONIE Version",": ", buf):\
-        vty_out(vty,"%-20s%s%-20s","ONIE Version",": "," ");
+    cli_json_open(&json, NULL, '{');
 
-    buf = smap_get (&pSys->other_info,"diag_version");
-    (buf) ? vty_out(vty,"%-20s%s%-10s%s",
-            "DIAG Version",": ", buf, VTY_NEWLINE):\
-        vty_out(vty,"%-20s%s%-10s%s","DIAG Version",": "," ", VTY_NEWLINE);
+    cli_json_open(&json, "system", '{');
+    cli_json_string(&json, "switch_version",
+                    pVswitch ? pVswitch->switch_version : NULL);
+    cli_json_open(&json, "other_info", '{');
+    if (pSys) {
+        const struct smap_node **nodes = smap_sort(&pSys->other_info);
 
-    buf = smap_get (&pSys->other_info,"base_mac_address");
-    (buf) ? vty_out(vty, "%-20s%s%-20s","Base MAC Address",": ", buf):\
-        vty_out(vty,"%-20s%s%-20s","Base MAC Address",": "," ");
+        for (i = 0; i < smap_count(&pSys->other_info); i++) {
+            cli_json_string(&json, nodes[i]->key, nodes[i]->value);
+        }
+        free(nodes);
+    }
+    cli_json_close(&json, '}');
+    cli_json_close(&json, '}');
+
+    cli_json_open(&json, "fans", '[');
+    for (i = 0; i < cache->fans.n; i++) {
+        const struct ovsrec_fan* pFan = cache->fans.rows[i];
+
+        cli_json_open(&json, NULL, '{');
+        cli_json_string(&json, "name", pFan->name);
+        cli_json_string(&json, "speed", pFan->speed);
+        cli_json_string(&json, "status", pFan->status);
+        if (pFan->n_rpm) {
+            cli_json_member(&json, "rpm");
+            ds_put_format(ds, "%"PRId64, pFan->rpm[0]);
+        }
+        cli_json_close(&json, '}');
+    }
+    cli_json_close(&json, ']');
+
+    cli_json_open(&json, "leds", '[');
+    OVSREC_LED_FOR_EACH (pLed,idl) {
+        cli_json_open(&json, NULL, '{');
+        cli_json_string(&json, "name", pLed->id);
+        cli_json_string(&json, "state", pLed->state);
+        cli_json_string(&json, "status", pLed->status);
+        cli_json_close(&json, '}');
+    }
+    cli_json_close(&json, ']');
 
-    buf = smap_get (&pSys->other_info,"number_of_macs");
-    (buf) ? vty_out(vty, "%-20s%s%-5s%s",
-            "Number of MACs",": ", buf, VTY_NEWLINE):\
-        vty_out(vty, "%-20s%s%-5s%s","Number of MACs",": "," ", VTY_NEWLINE);
+    cli_json_open(&json, "power_supplies", '[');
+    for (i = 0; i < cache->psus.n; i++) {
+        const struct ovsrec_power_supply* pPSU = cache->psus.rows[i];
 
-    buf = smap_get (&pSys->other_info,"interface_count");
-    (buf) ? vty_out(vty, "%-20s%s%-20s","Interface Count",": ", buf):\
-        vty_out(vty, "%-20s%s%-20s","Interface Count",": "," ");
+        cli_json_open(&json, NULL, '{');
+        cli_json_string(&json, "name", pPSU->name);
+        cli_json_string(&json, "status", pPSU->status);
+        cli_json_close(&json, '}');
+    }
+    cli_json_close(&json, ']');
+
+    cli_json_open(&json, "temperature_sensors", '[');
+    OVSREC_TEMP_SENSOR_FOR_EACH (pTempSen,idl) {
+        cli_json_open(&json, NULL, '{');
+        cli_json_string(&json, "location", pTempSen->location);
+        cli_json_string(&json, "name", pTempSen->name);
+        cli_json_member(&json, "temperature");
+        ds_put_format(ds, "%.3f", pTempSen->temperature / 1000.0);
+        cli_json_close(&json, '}');
+    }
+    cli_json_close(&json, ']');
 
-    buf = smap_get (&pSys->other_info,"max_interface_speed");
-    (buf) ? vty_out(vty, "%-20s%s%-6sMbps%s",
-            "Max Interface Speed",": ", buf, VTY_NEWLINE):\
-        vty_out(vty, "%-20s%s%-6sMbps%s",
-                "Max Interface Speed",": "," ", VTY_NEWLINE);
+    cli_json_close(&json, '}');
 }
 
-
 /*
- * Function        : cli_system_get_all
- * Resposibility     : Get System overview information from OVSDB
- * Return      : 0 on success 1 otherwise
+ * Function        : cli_system_cache_refresh
+ * Resposibility     : Rebuilds the sorted row indexes and the rendered
+ *        sections of "show system" if the IDL changed since they were
+ *        built. The indexes are sized from the tables themselves.
  */
-int
-cli_system_get_all()
+static void
+cli_system_cache_refresh(void)
 {
+    struct cli_system_cache *cache = &system_cache;
+    unsigned int seqno = ovsdb_idl_get_seqno(idl);
     const struct ovsrec_subsystem* pSys = NULL;
     const struct ovsrec_system* pVswitch = NULL;
     const struct ovsrec_fan* pFan = NULL;
-    struct ovsrec_fan* pFanSort = NULL;
     const struct ovsrec_led* pLed = NULL;
     const struct ovsrec_power_supply* pPSU = NULL;
-    struct ovsrec_power_supply* pPSUsort = NULL;
     const struct ovsrec_temp_sensor* pTempSen = NULL;
-    int n = 0, i = 0;
+    const char* nl = VTY_NEWLINE;
+    struct ds* ds;
+    size_t i;
+
+    if (cache->valid && cache->seqno == seqno
+        && !strcmp(cache->newline, nl)) {
+        return;
+    }
+
+    /* Row indexes. */
+    cache->fans.n = 0;
+    OVSREC_FAN_FOR_EACH (pFan,idl) {
+        cli_row_index_add(&cache->fans, pFan);
+    }
+    qsort(cache->fans.rows, cache->fans.n, sizeof *cache->fans.rows,
+          compare_fan);
+
+    cache->psus.n = 0;
+    OVSREC_POWER_SUPPLY_FOR_EACH (pPSU,idl) {
+        cli_row_index_add(&cache->psus, pPSU);
+    }
+    qsort(cache->psus.rows, cache->psus.n, sizeof *cache->psus.rows,
+          compare_psu);
+
+    for (i = 0; i < CLI_SYSTEM_N_SECTIONS; i++) {
+        ds_clear(&cache->sections[i]);
+    }
+    cache->json_valid = false;
 
+    /* System information. */
     pSys = ovsrec_subsystem_first(idl);
     pVswitch = ovsrec_system_first(idl);
-
     if (pSys && pVswitch) {
-        format_sys_output(vty, pSys,pVswitch);
+        format_sys_output(&cache->sections[CLI_SYSTEM_SECTION_INFO],
+                          pSys, pVswitch, nl);
     }
-    else {
-        VLOG_ERR("Unable to retrieve data\n");
+
+    /* Fans. */
+    ds = &cache->sections[CLI_SYSTEM_SECTION_FAN];
+    ds_put_format(ds, "%sFan details:%s%s", nl, nl, nl);
+    ds_put_format(ds, "%-15s%-10s%-10s%s", "Name", "Speed", "Status", nl);
+    ds_put_format(ds, "%s%s", "--------------------------------", nl);
+    for (i = 0; i < cache->fans.n; i++) {
+        pFan = cache->fans.rows[i];
+        ds_put_format(ds, "%-15s%-10s%-10s%s",
+                      pFan->name, pFan->speed, pFan->status, nl);
     }
 
+    /* LEDs. */
+    ds = &cache->sections[CLI_SYSTEM_SECTION_LED];
+    ds_put_format(ds, "%sLED details:%s%s", nl, nl, nl);
+    ds_put_format(ds, "%-10s%-10s%-8s%s", "Name", "State", "Status", nl);
+    ds_put_format(ds, "%s%s", "-------------------------", nl);
+    OVSREC_LED_FOR_EACH (pLed,idl) {
+        ds_put_format(ds, "%-10s%-10s%-8s%s",
+                      pLed->id, pLed->state, pLed->status, nl);
+    }
 
-    vty_out(vty,"%sFan details:%s%s",VTY_NEWLINE,VTY_NEWLINE, VTY_NEWLINE);
-    vty_out(vty,"%-15s%-10s%-10s%s","Name","Speed","Status",VTY_NEWLINE);
-    vty_out(vty,"%s%s","--------------------------------",VTY_NEWLINE);
-    n = pSys->n_fans;
-    if (0 != n)
-    {
-        pFanSort = (struct ovsrec_fan*)calloc (n,sizeof(struct ovsrec_fan));
+    /* Power supplies. */
+    ds = &cache->sections[CLI_SYSTEM_SECTION_PSU];
+    ds_put_format(ds, "%sPower supply details:%s%s", nl, nl, nl);
+    ds_put_format(ds, "%-10s%-10s%s", "Name", "Status", nl);
+    ds_put_format(ds, "%s%s", "-----------------------", nl);
+    for (i = 0; i < cache->psus.n; i++) {
+        pPSU = cache->psus.rows[i];
+        ds_put_format(ds, "%-15s%-10s%s",
+                      pPSU->name, format_psu_string(pPSU->status), nl);
+    }
 
-        OVSREC_FAN_FOR_EACH (pFan,idl)
-        {
-            memcpy (pFanSort+i,pFan,sizeof(struct ovsrec_fan));
-            i++;
+    /* Temperature sensors. */
+    ds = &cache->sections[CLI_SYSTEM_SECTION_TEMP];
+    ds_put_format(ds, "%sTemperature Sensors:%s%s", nl, nl, nl);
+    if (ovsrec_temp_sensor_first(idl) != NULL) {
+        ds_put_format(ds, "%-50s%-10s%-18s%s", "Location", "Name",
+                      "Reading(celsius)", nl);
+        ds_put_format(ds, "%s%s",
+                "---------------------------------------------------------------------------",
+                nl);
+        OVSREC_TEMP_SENSOR_FOR_EACH (pTempSen,idl) {
+            ds_put_format(ds, "%-50s%-10s%3.2f%s",
+                          pTempSen->location, pTempSen->name,
+                          (double)((pTempSen->temperature)/1000), nl);
         }
+    } else {
+        ds_put_format(ds, "%-10s%-10s%-18s%s", "Location", "Name",
+                      "Reading(celsius)", nl);
+        ds_put_format(ds, "%s%s", "------------------------------------", nl);
+    }
 
-        qsort((void*)pFanSort,n,sizeof(struct ovsrec_fan),compare_fan);
+    cache->valid = true;
+    cache->seqno = seqno;
+    cache->newline = nl;
+}
 
-        for (i = 0; i < n ; i++)
-        {
-            vty_out(vty,"%-15s",(pFanSort+i)->name);
-            vty_out(vty,"%-10s",(pFanSort+i)->speed);
-            vty_out(vty,"%-10s",(pFanSort+i)->status);
-            vty_out(vty,"%s",VTY_NEWLINE);
+/*
+ * Function        : cli_system_get_all
+ * Resposibility     : Get System overview information from OVSDB
+ * Return      : 0 on success 1 otherwise
+ */
+int
+cli_system_get_all()
+{
+    int i;
+
+    cli_system_cache_refresh();
+
+    if (!system_cache.sections[CLI_SYSTEM_SECTION_INFO].length) {
+        VLOG_ERR("Unable to retrieve data\n");
+    }
+
+    for (i = 0; i < CLI_SYSTEM_N_SECTIONS; i++) {
+        if (system_cache.sections[i].length) {
+            vty_out(vty, "%s", ds_cstr(&system_cache.sections[i]));
         }
     }
 
-    if (pFanSort)
-    {
-        free(pFanSort);
-        pFanSort = NULL;
+    return CMD_SUCCESS;
+}
+
+
+DEFUN (cli_platform_show_system,
+        cli_platform_show_system_cmd,
+        "show system",
+        SHOW_STR
+        SYS_STR)
+{
+    return cli_system_get_all();
+}
+
+DEFUN (cli_platform_show_system_json,
+        cli_platform_show_system_json_cmd,
+        "show system json",
+        SHOW_STR
+        SYS_STR
+        JSON_STR)
+{
+    struct cli_system_cache *cache = &system_cache;
+
+    cli_system_cache_refresh();
+    if (!cache->json_valid) {
+        ds_clear(&cache->json);
+        format_sys_json(&cache->json, cache);
+        cache->json_valid = true;
     }
+    vty_out(vty, "%s%s", ds_cstr(&cache->json), VTY_NEWLINE);
+    return CMD_SUCCESS;
+}
 
-    vty_out(vty,"%sLED details:%s%s",VTY_NEWLINE,VTY_NEWLINE, VTY_NEWLINE);
-    vty_out(vty,"%-10s%-10s%-8s%s","Name","State","Status",VTY_NEWLINE);
-    vty_out(vty,"%s%s","-------------------------",VTY_NEWLINE);
+/*
+ * Function        : cli_localtime
+ * Resposibility   : Converts a time to local time in a posix timezone. vtysh
+ *                   loads /etc/localtime once, so the zone configured in the
+ *                   System table is read from its tzfile for the conversion.
+ *                   TZ is left alone: the other vtysh threads use it
+ * Parameters      :
+ *  zone - posix timezone name, or NULL for the process timezone
+ */
+static void
+cli_localtime(const char *zone, time_t t, struct tm *tm)
+{
+    char *path;
 
-    n = pSys->n_leds;
-    if (0 != n)
-    {
+    if (!zone || !zone[0]) {
+        localtime_r(&t, tm);
+        return;
+    }
 
-        OVSREC_LED_FOR_EACH (pLed,idl)
-        {
-            vty_out(vty,"%-10s",pLed->id);
-            vty_out(vty,"%-10s",pLed->state);
-            vty_out(vty,"%-8s",pLed->status);
-            vty_out(vty,"%s",VTY_NEWLINE);
+    path = xasprintf("%s%s", TIMEZONE_POSIX_DIR, zone);
+    if (!system_tz_localtime(path, t, tm)) {
+        /* Like TZ naming a missing zone. */
+        VLOG_DBG("Unable to read timezone %s, using UTC", path);
+        gmtime_r(&t, tm);
+    }
+    free(path);
+}
+
+/*
+ * Function        : cli_watch_put
+ * Resposibility     : Adds a rendered row to a "show system watch" snapshot.
+ *        The key sorts the rows like the "show system" sections, and the row
+ *        UUID keeps rows with the same name apart
+ */
+static void
+cli_watch_put(struct shash* snapshot, const char* table,
+              const struct ovsdb_idl_row* row, const char* name, char* line)
+{
+    shash_add_nocopy(snapshot,
+                     xasprintf("%s %s "UUID_FMT, table, name ? name : "",
+                               UUID_ARGS(&row->uuid)),
+                     line);
+}
+
+/*
+ * Function        : cli_system_watch_snapshot
+ * Resposibility     : Renders the Fan, LED, Power_supply and Temp_sensor rows
+ *        as "show system watch" prints them, one line per row
+ * Parameters
+ *  snapshot: Filled with the rendered rows, keyed by table, name and UUID
+ */
+static void
+cli_system_watch_snapshot(struct shash* snapshot)
+{
+    const struct ovsrec_fan* pFan = NULL;
+    const struct ovsrec_led* pLed = NULL;
+    const struct ovsrec_power_supply* pPSU = NULL;
+    const struct ovsrec_temp_sensor* pTempSen = NULL;
+
+    OVSREC_FAN_FOR_EACH (pFan,idl) {
+        cli_watch_put(snapshot, "Fan", &pFan->header_, pFan->name,
+                      xasprintf("%-6s%-15s%-10s%-10s", "Fan",
+                                pFan->name, pFan->speed, pFan->status));
+    }
+    OVSREC_LED_FOR_EACH (pLed,idl) {
+        cli_watch_put(snapshot, "LED", &pLed->header_, pLed->id,
+                      xasprintf("%-6s%-15s%-10s%-10s", "LED",
+                                pLed->id, pLed->state, pLed->status));
+    }
+    OVSREC_POWER_SUPPLY_FOR_EACH (pPSU,idl) {
+        cli_watch_put(snapshot, "PSU", &pPSU->header_, pPSU->name,
+                      xasprintf("%-6s%-15s%-10s", "PSU", pPSU->name,
+                                format_psu_string(pPSU->status)));
+    }
+    OVSREC_TEMP_SENSOR_FOR_EACH (pTempSen,idl) {
+        cli_watch_put(snapshot, "Temp", &pTempSen->header_, pTempSen->name,
+                      xasprintf("%-6s%-15s%3.2f", "Temp", pTempSen->name,
+                                pTempSen->temperature / 1000.0));
+    }
+}
+
+/*
+ * Function        : cli_system_watch_changes
+ * Resposibility     : Renders the rows that differ between two snapshots,
+ *        in "show system" order, then the rows that were removed
+ * Parameters
+ *      ds  : Buffer to render into
+ *  old     : Snapshot of the last update
+ *  new     : Current snapshot
+ *  stamp   : Time of the update
+ *      nl  : Newline of the vty
+ */
+static void
+cli_system_watch_changes(struct ds* ds, const struct shash* old,
+                         const struct shash* new, const char* stamp,
+                         const char* nl)
+{
+    const struct shash_node **nodes;
+    size_t i;
+
+    nodes = shash_sort(new);
+    for (i = 0; i < shash_count(new); i++) {
+        const char *line = nodes[i]->data;
+        const char *before = shash_find_data(old, nodes[i]->name);
+
+        if (!before || strcmp(before, line)) {
+            ds_put_format(ds, "%s %s%s%s", stamp, line,
+                          before ? "" : " (added)", nl);
         }
     }
+    free(nodes);
 
-    vty_out(vty,"%sPower supply details:%s%s",VTY_NEWLINE,VTY_NEWLINE,
-            VTY_NEWLINE);
-    vty_out(vty,"%-10s%-10s%s","Name","Status",VTY_NEWLINE);
-    vty_out(vty,"%s%s","-----------------------",VTY_NEWLINE);
-    n = pSys->n_power_supplies;
+    nodes = shash_sort(old);
+    for (i = 0; i < shash_count(old); i++) {
+        if (!shash_find(new, nodes[i]->name)) {
+            ds_put_format(ds, "%s %s (removed)%s", stamp,
+                          (const char *) nodes[i]->data, nl);
+        }
+    }
+    free(nodes);
+}
 
-    if (n > 0)
-    {
-        pPSUsort = (struct ovsrec_power_supply*)calloc(n,
-					sizeof(struct ovsrec_power_supply));
+/*
+ * Function        : cli_system_watch
+ * Resposibility     : Prints the "show system" snapshot, then only the rows
+ *        that change, at most once per 'interval' seconds, until a line is
+ *        entered on the terminal. Runs the IDL itself, under the vtysh IDL
+ *        lock. Changes are found by comparing the rendered rows with those
+ *        of the last update, so nothing is left behind in the shared IDL.
+ * Parameters
+ *  interval: Minimum number of seconds between two updates
+ * Return      : CMD_SUCCESS
+ */
+static int
+cli_system_watch(int interval)
+{
+    const struct ovsrec_system *ovs;
+    struct pollfd input = { .fd = STDIN_FILENO, .events = POLLIN };
+    long long int next = 0;
+    bool pending = false;
+    unsigned int seqno;
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    struct shash old = SHASH_INITIALIZER(&old);
+    struct shash new = SHASH_INITIALIZER(&new);
+
+    cli_system_get_all();
+    cli_system_watch_snapshot(&old);
+    vty_out(vty, "%sWatching for changes every %d second(s), press Enter to stop.%s",
+            VTY_NEWLINE, interval, VTY_NEWLINE);
+    fflush(stdout);
+
+    seqno = ovsdb_idl_get_seqno(idl);
+    for (;;) {
+        ovsdb_idl_run(idl);
+        if (ovsdb_idl_get_seqno(idl) != seqno) {
+            seqno = ovsdb_idl_get_seqno(idl);
+            pending = true;
+        }
 
-        i = 0;
-        OVSREC_POWER_SUPPLY_FOR_EACH (pPSU,idl)
-        {
-            if (pPSU)
-            {
-                memcpy(pPSUsort+i,pPSU,sizeof(struct ovsrec_power_supply));
-                i++;
+        if (pending && time_msec() >= next) {
+            char stamp[16];
+            struct tm tm;
+
+            ovs = ovsrec_system_first(idl);
+            cli_localtime(ovs ? ovs->timezone : NULL, time(NULL), &tm);
+            strftime(stamp, sizeof stamp, "%H:%M:%S", &tm);
+
+            cli_system_watch_snapshot(&new);
+            ds_clear(&ds);
+            cli_system_watch_changes(&ds, &old, &new, stamp, VTY_NEWLINE);
+            if (ds.length) {
+                vty_out(vty, "%s", ds_cstr(&ds));
+                fflush(stdout);
             }
-	}
+            shash_swap(&old, &new);
+            shash_clear_free_data(&new);
+            pending = false;
+            next = time_msec() + interval * 1000LL;
+        }
 
-        qsort((void*)pPSUsort,n,sizeof(struct ovsrec_power_supply),compare_psu);
+        if (poll(&input, 1, 0) > 0) {
+            char line[VTY_BUFSIZ];
 
-        for (i = 0; i < n ; i++)
-        {
-            vty_out(vty,"%-15s",(pPSUsort+i)->name);
-            vty_out(vty,"%-10s",format_psu_string((pPSUsort+i)->status));
-            vty_out(vty,"%s",VTY_NEWLINE);
+            if (!fgets(line, sizeof line, stdin)) {
+                clearerr(stdin);
+            }
+            break;
         }
 
-        if(pPSUsort)
-	{
-            free(pPSUsort);
-            pPSUsort = NULL;
-	}
+        ovsdb_idl_wait(idl);
+        if (pending) {
+            poll_timer_wait_until(next);
+        }
+        poll_fd_wait(STDIN_FILENO, POLLIN);
+        poll_block();
     }
 
-    vty_out(vty,"%sTemperature Sensors:%s%s",VTY_NEWLINE,VTY_NEWLINE,
-            VTY_NEWLINE);
-    n = pSys->n_temp_sensors;
-    if ( 0 !=  n)
-    {
+    shash_destroy_free_data(&old);
+    shash_destroy_free_data(&new);
+    ds_destroy(&ds);
+    return CMD_SUCCESS;
+}
 
-        vty_out(vty,"%-50s%-10s%-18s%s","Location","Name",
-                "Reading(celsius)",VTY_NEWLINE);
-        vty_out(vty,"%s%s",
-                "---------------------------------------------------------------------------",VTY_NEWLINE);
-        OVSREC_TEMP_SENSOR_FOR_EACH (pTempSen,idl)
-        {
-            vty_out(vty,"%-50s",pTempSen->location);
-            vty_out(vty,"%-10s",pTempSen->name);
-            vty_out(vty,"%3.2f",(double)((pTempSen->temperature)/1000));
-            vty_out(vty,"%s",VTY_NEWLINE);
-        }
+/*
+ * Function        : cli_show_clock
+ * Resposibility   : Displays the current time in the configured timezone, in
+ *                   the format of date(1), or in ISO 8601 format with seconds
+ *                   or nanoseconds, without forking date
+ * Parameters      :
+ *  format - NULL, "iso8601" or "high-resolution"
+ * Return          : Returns CMD_SUCCESS on successful completion
+ */
+static int
+cli_show_clock(const char *format)
+{
+    const struct ovsrec_system *ovs = ovsrec_system_first(idl);
+    struct timespec now;
+    struct tm tm;
+    char buf[64];
+    long offset;
+
+    if (clock_gettime(CLOCK_REALTIME, &now)) {
+        VLOG_ERR("clock_gettime failed (%s)", ovs_strerror(errno));
+        return CMD_WARNING;
     }
-    else
-    {
-        vty_out(vty,"%-10s%-10s%-18s%s","Location","Name",
-                "Reading(celsius)",VTY_NEWLINE);
-        vty_out(vty,"%s%s","------------------------------------",VTY_NEWLINE);
+    cli_localtime(ovs ? ovs->timezone : NULL, now.tv_sec, &tm);
+
+    if (!format) {
+        strftime(buf, sizeof buf, "%a %b %e %H:%M:%S %Z %Y", &tm);
+        vty_out(vty, "%s%s", buf, VTY_NEWLINE);
+        return CMD_SUCCESS;
     }
 
+    strftime(buf, sizeof buf, "%Y-%m-%dT%H:%M:%S", &tm);
+    offset = tm.tm_gmtoff / 60;
+    if (!strcmp(format, "high-resolution")) {
+        vty_out(vty, "%s.%09ld", buf, (long) now.tv_nsec);
+    } else {
+        vty_out(vty, "%s", buf);
+    }
+    vty_out(vty, "%c%02ld:%02ld%s", offset < 0 ? '-' : '+',
+            labs(offset) / 60, labs(offset) % 60, VTY_NEWLINE);
     return CMD_SUCCESS;
 }
 
-
-DEFUN (cli_platform_show_system,
-        cli_platform_show_system_cmd,
-        "show system",
+DEFUN ( vtysh_show_system_clock,
+        vtysh_show_system_clock_cmd,
+        "show system clock",
         SHOW_STR
-        SYS_STR)
+        SYS_STR
+        CLOCK_STR
+      )
 {
-    return cli_system_get_all();
+    return cli_show_clock(NULL);
 }
 
-DEFUN_NOLOCK ( vtysh_show_system_clock,
-        vtysh_show_system_clock_cmd,
-        "show system clock",
+DEFUN ( vtysh_show_system_clock_format,
+        vtysh_show_system_clock_format_cmd,
+        "show system clock (iso8601|high-resolution)",
         SHOW_STR
         SYS_STR
         CLOCK_STR
+        CLOCK_ISO8601_STR
+        CLOCK_HIGH_RES_STR
       )
 {
-    execute_command("date", 0, (const char **) NULL);
-    return CMD_SUCCESS;
+    return cli_show_clock(argv[0]);
 }
-DEFUN_NOLOCK ( vtysh_show_date,
+
+DEFUN ( vtysh_show_date,
         vtysh_show_date_cmd,
         "show date",
         SHOW_STR
         DATE_STR
       )
 {
-    execute_command("date", 0, (const char **) NULL);
-    return CMD_SUCCESS;
+    return cli_show_clock(NULL);
+}
+
+DEFUN ( vtysh_show_date_format,
+        vtysh_show_date_format_cmd,
+        "show date (iso8601|high-resolution)",
+        SHOW_STR
+        DATE_STR
+        CLOCK_ISO8601_STR
+        CLOCK_HIGH_RES_STR
+      )
+{
+    return cli_show_clock(argv[0]);
+}
+
+DEFUN ( cli_platform_show_system_watch,
+        cli_platform_show_system_watch_cmd,
+        "show system watch",
+        SHOW_STR
+        SYS_STR
+        WATCH_STR
+      )
+{
+    return cli_system_watch(SYSTEM_WATCH_DEFAULT_INTERVAL);
+}
+
+DEFUN ( cli_platform_show_system_watch_interval,
+        cli_platform_show_system_watch_interval_cmd,
+        "show system watch interval <1-3600>",
+        SHOW_STR
+        SYS_STR
+        WATCH_STR
+        WATCH_INTERVAL_STR
+        "Seconds\n"
+      )
+{
+    return cli_system_watch(atoi(argv[0]));
 }
 
 /*
@@ -368,7 +892,7 @@ DEFUN_NOLOCK ( vtysh_show_date,
  * Return          : Returns CMD_SUCCESS on successful completion
  */
 
-DEFUN_NOLOCK ( vtysh_show_system_timezone,
+DEFUN ( vtysh_show_system_timezone,
         vtysh_show_system_timezone_cmd,
         "show system timezone",
         SHOW_STR
@@ -376,71 +900,231 @@ DEFUN_NOLOCK ( vtysh_show_system_timezone,
         TIMEZONE_STR
       )
 {
-    char temp_file_path[]= "/tmp/timezone_info";
-    char output[VTY_BUFSIZ];
-    FILE *tmp_fp = NULL;
-    const struct ovsrec_system *ovs= NULL;
-    struct ovsdb_idl_txn* status_txn = NULL;
-    enum ovsdb_idl_txn_status status = TXN_ERROR;
-    const struct ovsdb_datum *data = NULL;
-    char *ovsdb_timezone = NULL;
+    const struct ovsrec_system *ovs = ovsrec_system_first(idl);
+    const char *zone = ovs ? ovs->timezone : NULL;
+    struct tm tm;
+    char abbrev[16];
+    long offset;
 
-    ovs = ovsrec_system_first(idl);
-    if (ovs) {
-        status_txn = cli_do_config_start();
-        if(status_txn == NULL) {
-            cli_do_config_abort(status_txn);
-            VLOG_ERR("Couldn't create the OVSDB transaction.");
-        } else {
-            data = ovsrec_system_get_timezone(ovs, OVSDB_TYPE_STRING);
-            ovsdb_timezone = data->keys->string;
-            if (ovsdb_timezone != NULL)
-            {
-               vty_out(vty, "System is configured for timezone : %s\n",ovsdb_timezone);
-            }
+    if (!ovs) {
+        VLOG_ERR("Unable to retrieve any system table rows");
+    } else if (zone) {
+        vty_out(vty, "System is configured for timezone : %s%s", zone, VTY_NEWLINE);
+    }
 
-            status = cli_do_config_finish(status_txn);
+    cli_localtime(zone, time(NULL), &tm);
+    if (!strftime(abbrev, sizeof abbrev, "%Z", &tm)) {
+        abbrev[0] = '\0';
+    }
+    offset = tm.tm_gmtoff / 60;
+    vty_out(vty, "Timezone abbreviation             : %s%s", abbrev, VTY_NEWLINE);
+    vty_out(vty, "UTC offset                        : %c%02ld:%02ld%s",
+            offset < 0 ? '-' : '+', labs(offset) / 60, labs(offset) % 60,
+            VTY_NEWLINE);
+    vty_out(vty, "Daylight saving time              : %s%s",
+            tm.tm_isdst > 0 ? "active" : "inactive", VTY_NEWLINE);
+    return CMD_SUCCESS;
+}
+
+/*
+ * Zone db, from the timezone catalog generated at build time: a string pool
+ * holding the lower case name of each zone followed by its canonical name,
+ * and the offset of each zone in the pool, sorted by lower case name.
+ */
+#define ZONE_COUNT TIMEZONE_CATALOG_COUNT
+
+static const char zone_pool[] = TIMEZONE_CATALOG_POOL;
+static const uint16_t zone_offsets[ZONE_COUNT] = { TIMEZONE_CATALOG_OFFSETS };
+
+/* Zones of the zone db, hashed by their lower case name. */
+struct zone_index_node {
+    struct hmap_node node;
+    int zone;                   /* Index into zone_offsets. */
+};
+
+static struct hmap zone_index = HMAP_INITIALIZER(&zone_index);
+static struct zone_index_node zone_index_nodes[ZONE_COUNT];
+
+static void load_timezone_catalog(void);
+
+/* Returns the lower case name of 'zone'. */
+static inline const char *
+zone_name(int zone)
+{
+    return &zone_pool[zone_offsets[zone]];
+}
+
+/* Returns the canonical name of 'zone'. */
+static inline const char *
+zone_name_caps(int zone)
+{
+    const char *name = zone_name(zone);
+
+    return name + strlen(name) + 1;
+}
+
+/*
+ * Function        : find_zone
+ * Resposibility   : Looks up a zone in the zone db by name, ignoring case
+ * Parameters      :
+ *  timezone - zone name, in any case
+ * Return          : Returns -1 if not found and the zone index otherwise
+ */
+static int
+find_zone(const char *timezone)
+{
+    char zone[MAX_TIMEZONE_NAME_SIZE];
+    struct zone_index_node *n;
+    size_t i;
+
+    for (i = 0; timezone[i]; i++) {
+        if (i == sizeof(zone) - 1) {
+            return -1;
         }
-        if(!(status == TXN_SUCCESS || status == TXN_UNCHANGED))
-            VLOG_ERR("Committing transaction to DB failed.");
-    } else {
-        VLOG_ERR("Unable to retrieve any system table rows");
+        zone[i] = tolower((unsigned char) timezone[i]);
     }
+    zone[i] = '\0';
 
+    HMAP_FOR_EACH_WITH_HASH (n, node, hash_string(zone, 0), &zone_index) {
+        if (!strcmp(zone_name(n->zone), zone)) {
+            return n->zone;
+        }
+    }
+    return -1;
+}
 
-    remove(temp_file_path);
-    tmp_fp = popen("timedatectl status >> /tmp/timezone_info","w");
-    pclose(tmp_fp);
-    tmp_fp = fopen(temp_file_path, "r");
-    int line_count = 0;
-    if (tmp_fp)
-    {
-        while ( fgets( output, VTY_BUFSIZ, tmp_fp ) != NULL && line_count < 6)
-            line_count++;
-        while ( fgets( output, VTY_BUFSIZ, tmp_fp ) != NULL)
-            vty_out (vty, "%s", output);
+/*
+ * Function        : complete_zone
+ * Resposibility   : Finds the zones whose name starts with a prefix, by binary
+ *                   search of the zone db, which is sorted by name
+ * Parameters      :
+ *  prefix - start of a zone name, in any case
+ *  first  - set to the index of the first matching zone
+ * Return          : Returns the number of matching zones
+ */
+static int
+complete_zone(const char *prefix, int *first)
+{
+    char zone[MAX_TIMEZONE_NAME_SIZE];
+    int low = 0, high = ZONE_COUNT;
+    size_t i, len;
+
+    for (i = 0; prefix[i]; i++) {
+        if (i == sizeof(zone) - 1) {
+            return 0;
+        }
+        zone[i] = tolower((unsigned char) prefix[i]);
     }
-    else
-    {
-        VLOG_ERR("Failed to get information");
-        return CMD_ERR_NO_MATCH;
+    zone[i] = '\0';
+    len = i;
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+
+        if (strcmp(zone_name(mid), zone) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
     }
-    fclose(tmp_fp);
-    return CMD_SUCCESS;
+    *first = low;
+    while (high < ZONE_COUNT && !strncmp(zone_name(high), zone, len)) {
+        high++;
+    }
+    return high - low;
+}
+
+/*
+ * Function        : resolve_zone
+ * Resposibility   : Validates and completes the TIMEZONE token. Accepts a zone
+ *                   name in any case or a prefix of exactly one zone, and lists
+ *                   the candidates of an ambiguous prefix
+ * Return          : Returns -1 on error and the zone index otherwise
+ */
+static int
+resolve_zone(const char *timezone)
+{
+    int zone, first = 0, n, i;
+
+    zone = find_zone(timezone);
+    if (zone >= 0) {
+        return zone;
+    }
+
+    n = complete_zone(timezone, &first);
+    if (n == 1) {
+        return first;
+    } else if (n == 0) {
+        vty_out(vty, "%s%s", "Invalid timezone specified, please use a valid timezone", VTY_NEWLINE);
+        return -1;
+    }
+
+    vty_out(vty, "Ambiguous timezone %s, %d zones match:%s", timezone, n, VTY_NEWLINE);
+    for (i = first; i < first + MIN(n, MAX_TIMEZONE_CANDIDATES); i++) {
+        vty_out(vty, "  %s%s", zone_name(i), VTY_NEWLINE);
+    }
+    if (n > MAX_TIMEZONE_CANDIDATES) {
+        vty_out(vty, "  ...%s", VTY_NEWLINE);
+    }
+    return -1;
+}
+
+/*
+ * Function        : timezone_dyn_helpstr
+ * Resposibility   : Help for the TIMEZONE token on '?'. Lists the zones that
+ *                   start with the word typed so far, taken from the vtysh
+ *                   readline buffer since the token itself is not passed in.
+ *                   There is no hook for <TAB> on a variable token, so zone
+ *                   names are completed with '?' rather than <TAB>
+ */
+static void
+timezone_dyn_helpstr(struct cmd_token *token, struct vty *vty,
+                     char * const dyn_helpstr_ptr, int max_strlen)
+{
+    struct ds help = DS_EMPTY_INITIALIZER;
+    char prefix[MAX_TIMEZONE_NAME_SIZE];
+    const char *line = rl_line_buffer ? rl_line_buffer : "";
+    int end = MIN(rl_point, (int) strlen(line));
+    int start = end;
+    int first = 0, n, i;
+
+    while (start > 0 && !isspace((unsigned char) line[start - 1])) {
+        start--;
+    }
+    ovs_strlcpy(prefix, &line[start], MIN(end - start + 1, sizeof prefix));
+
+    n = complete_zone(prefix, &first);
+    if (!prefix[0]) {
+        ds_put_format(&help, "Timezone name, one of %d; type its start and "
+                      "'?' to list matches", n);
+    } else if (n == 0) {
+        ds_put_format(&help, "No timezone starts with %s", prefix);
+    } else {
+        ds_put_format(&help, "Timezone, %d match%s:", n, n == 1 ? "" : "es");
+        for (i = first; i < first + n; i++) {
+            /* Leave room for " ..." if the list does not fit. */
+            if (help.length + strlen(zone_name(i)) + 5 >= max_strlen) {
+                ds_put_cstr(&help, " ...");
+                break;
+            }
+            ds_put_format(&help, " %s", zone_name(i));
+        }
+    }
+
+    ovs_strlcpy(dyn_helpstr_ptr, ds_cstr(&help), max_strlen);
+    ds_destroy(&help);
 }
 
 /*
  * Function        : translate_cmd_to_filepath
- * Resposibility   : Maps user provided timezone info to full file path
+ * Resposibility   : Maps user provided timezone info to its zone db entry
  * Return          : Returns -1 on error and zone_index on successful completion
  */
 int translate_cmd_to_filepath(char *timezone_cmd, char *timezone_info) {
-  int i = 0;
-  for (i=0;i<zone_count;i++) {
-    if (strcmp(list_of_zones[i], timezone_cmd) == 0) {
-      strcpy(timezone_info, list_of_zones[i]);
-      return i;
-    }
+  int i = find_zone(timezone_cmd);
+  if (i >= 0) {
+    strcpy(timezone_info, zone_name(i));
+    return i;
   }
   timezone_info[0] = 0;
   return -1;
@@ -451,7 +1135,7 @@ int translate_cmd_to_filepath(char *timezone_cmd, char *timezone_info) {
  * Resposibility   : Helper function to set/unset the user configured timezone into OVSDB
  * Return          : Returns CMD_ERR_NO_MATCH on error and CMD_SUCCESS on successful completion
  */
-int cli_set_timezone(char *timezone_info, int no_flags) {
+int cli_set_timezone(const char *timezone_info, int no_flags) {
     int ret_val = -1;
     char timezone_cmd[500];
     char timezone[MAX_TIMEZONE_NAME_SIZE];
@@ -463,6 +1147,12 @@ int cli_set_timezone(char *timezone_info, int no_flags) {
     char timezone_from_ovsdb[MAX_TIMEZONE_NAME_SIZE];
     int i=0;
 
+    ret_val = resolve_zone(timezone_info);
+    if (ret_val < 0) {
+        return CMD_ERR_NO_MATCH;
+    }
+    timezone_info = zone_name(ret_val);
+
     memset(timezone, 0, sizeof(timezone));
     memset(timezone_cmd, 0, sizeof(timezone_cmd));
     strcpy(timezone_cmd, DEFAULT_TIMEZONE);
@@ -500,9 +1190,9 @@ int cli_set_timezone(char *timezone_info, int no_flags) {
               return CMD_ERR_NO_MATCH;
             }
             strcpy(timezone_cmd, "/usr/share/zoneinfo/posix");
-            strcat(timezone_cmd, list_of_zones_caps[ret_val]);
+            strcat(timezone_cmd, zone_name_caps(ret_val));
 
-            ovsrec_system_set_timezone(ovs, list_of_zones_caps[ret_val]);
+            ovsrec_system_set_timezone(ovs, zone_name_caps(ret_val));
             status = cli_do_config_finish(status_txn);
         }
         if(!(status == TXN_SUCCESS || status == TXN_UNCHANGED))
@@ -518,11 +1208,13 @@ int cli_set_timezone(char *timezone_info, int no_flags) {
  * Resposibility   : Sets the user configured timezone into OVSDB
  * Return          : Returns CMD_ERR_NO_MATCH on error and CMD_SUCCESS on successful completion
  */
-DEFUN (cli_platform_timezone_set,
-        cli_platform_timezone_set_cmd,
-       "timezone set ",
+DEFUN_DYN_HELPSTR (cli_platform_timezone_set,
+       cli_platform_timezone_set_cmd,
+       "timezone set TIMEZONE",
        TIMEZONE_STR
-       TIMEZONE_SET_STR)
+       TIMEZONE_SET_STR
+       TIMEZONE_PLACEHOLDER_STR,
+       "\n\ntimezone_dyn_helpstr\n")
 {
   return cli_set_timezone((char *) argv[0], false);
 }
@@ -532,12 +1224,14 @@ DEFUN (cli_platform_timezone_set,
  * Resposibility   : Unsets the user configured timezone into OVSDB
  * Return          : Returns CMD_ERR_NO_MATCH on error and CMD_SUCCESS on successful completion
  */
-DEFUN (cli_platform_timezone_set_no_form,
+DEFUN_DYN_HELPSTR (cli_platform_timezone_set_no_form,
        cli_platform_timezone_set_cmd_no_form,
-       "no timezone set ",
+       "no timezone set TIMEZONE",
        NO_STR
        TIMEZONE_STR
-       TIMEZONE_SET_STR)
+       TIMEZONE_SET_STR
+       TIMEZONE_PLACEHOLDER_STR,
+       "\n\n\ntimezone_dyn_helpstr\n")
 {
   return cli_set_timezone((char *) argv[0], true);
 }
@@ -597,37 +1291,8 @@ system_ovsdb_init()
  */
 int system_install_timezone_set_command()
 {
-    char *help = NULL, *help_no_form = NULL;
-    char *cmd = NULL, *cmd_no_form = NULL;
-
-    cmd  = (char*)calloc(MAX_TIMEZONES, MAX_TIMEZONE_NAME_SIZE);
-    help = (char*)calloc(MAX_TIMEZONES, MAX_TIMEZONE_HELP_SIZE);
-    cmd_no_form  = (char*)calloc(MAX_TIMEZONES, MAX_TIMEZONE_NAME_SIZE);
-    help_no_form = (char*)calloc(MAX_TIMEZONES, MAX_TIMEZONE_HELP_SIZE);
-
-    if(!cmd && !help && !cmd_no_form && !help_no_form) {
-        VLOG_ERR("Memory allocation failure");
-        return -1;
-    }
-
-    strncpy(cmd, "timezone set (", (MAX_TIMEZONE_CMD_SIZE-1));
-    strncpy(cmd_no_form, "no ", (MAX_TIMEZONE_CMD_SIZE-1));
-    strncpy(help, cli_platform_timezone_set_cmd.doc,
-       (MAX_TIMEZONES_HELP_SIZE-1));
-    strncpy(help_no_form, cli_platform_timezone_set_cmd_no_form.doc,
-         (MAX_TIMEZONES_HELP_SIZE-1));
-
-    find_posix_timezones_and_add_to_list("/usr/share/zoneinfo/posix", 0, cmd, help);
-
-    strncat(cmd, ")", (MAX_TIMEZONE_CMD_SIZE - strlen(cmd)));
-    strncat(cmd_no_form, cmd, strlen(cmd));
-    strncpy(help_no_form, help, strlen(help));
-
-    cli_platform_timezone_set_cmd.string = cmd;
-    cli_platform_timezone_set_cmd.doc = help;
-
-    cli_platform_timezone_set_cmd_no_form.string = cmd_no_form;
-    cli_platform_timezone_set_cmd_no_form.doc = help_no_form;
+    load_timezone_catalog();
+    install_dyn_helpstr_funcptr("timezone_dyn_helpstr", timezone_dyn_helpstr);
 
     //Installing element with CONFIG_NODE
     install_element (CONFIG_NODE, &cli_platform_timezone_set_cmd);
@@ -636,86 +1301,20 @@ int system_install_timezone_set_command()
 }
 
 /*
- * Function        : populate_zone_db
- * Resposibility   : Reads the posix timezones and populates info within the zone db
- *                   list_of_zones and list_of_zones_caps
- * Return          : Returns -1 on error and 0 on successful completion
+ * Function        : load_timezone_catalog
+ * Resposibility   : Indexes the zones of the zone db by name
  */
-void populate_zone_db(char *zone, char *zone_caps)
+static void
+load_timezone_catalog(void)
 {
-  strcpy(&list_of_zones[zone_count][0], zone);
-  strcpy(&list_of_zones_caps[zone_count][0], zone_caps);
-  zone_count++;
-}
+    int i;
 
-/*
- * Function        : add_info_to_cmd_options
- * Resposibility   : Helper function to add zone with the cli command and help strings
- */
-void add_info_to_cmd_options(char *timezone, char *cmd, char *help)
-{
-    char zone_caps[MAX_TIMEZONE_NAME_SIZE];
-    int i = 0;
-    memset(&zone_caps[0], 0, sizeof(zone_caps));
+    for (i = 0; i < ZONE_COUNT; i++) {
+        struct zone_index_node *n = &zone_index_nodes[i];
 
-    strcat(help, timezone);
-    strcat(help, " Zone \n");
-    strcpy(zone_caps, timezone);
-    for (i=0;i<strlen(timezone);i++) {
-      timezone[i] = tolower(timezone[i]);
+        n->zone = i;
+        hmap_insert(&zone_index, &n->node, hash_string(zone_name(i), 0));
     }
-    strcat(cmd, timezone);
-    strcat(cmd, " | ");
-    populate_zone_db(timezone, zone_caps);
-}
-
-/*
- * Function        : remove_base_path
- * Resposibility   : Removes base_path from the input string full_path
- * Parameters      :
- *  full_path - full path to timezone file
- *  base_path - top level timezone diretory
- * Return          : Returns modified full_path variable
- */
-void remove_base_path(char *full_path,const char *base_path)
-{
-  while( (full_path=strstr(full_path,base_path)) && (full_path!=NULL) )
-    memmove(full_path,full_path+strlen(base_path),1+strlen(full_path+strlen(base_path)));
-}
-
-/*
- * Function        : find_posix_timezones_and_add_to_list
- * Resposibility   : Reads the posix timezones and populates info within the zone db
- *                   list_of_zones and list_of_zones_caps
- */
-void find_posix_timezones_and_add_to_list(const char *name, int level, char *cmd, char *help)
-{
-  DIR *dir;
-  struct dirent *entry;
-  char local_dir[100];
-  char path[1024];
-  int len;
-  if (!(dir = opendir(name)))
-      return;
-  if (!(entry = readdir(dir)))
-      return;
-
-  do {
-      if (entry->d_type == DT_DIR) {
-          len = snprintf(path, sizeof(path)-1, "%s/%s", name, entry->d_name);
-          path[len] = 0;
-          if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
-              continue;
-          find_posix_timezones_and_add_to_list(path, level + 1, cmd, help);
-      }
-      else {
-          int ilen = snprintf(local_dir, sizeof(local_dir)-1, "%s/%s", name, entry->d_name);
-          local_dir[ilen] = 0;
-          remove_base_path(local_dir, base_path);
-          add_info_to_cmd_options(local_dir, cmd, help);
-      }
-  } while ((entry = readdir(dir)) && (entry != NULL));
-  closedir(dir);
 }
 
 /*
@@ -770,10 +1369,20 @@ cli_post_init(void)
 
     install_element (ENABLE_NODE, &cli_platform_show_system_cmd);
     install_element (VIEW_NODE, &cli_platform_show_system_cmd);
+    install_element (ENABLE_NODE, &cli_platform_show_system_json_cmd);
+    install_element (VIEW_NODE, &cli_platform_show_system_json_cmd);
+    install_element (ENABLE_NODE, &cli_platform_show_system_watch_cmd);
+    install_element (VIEW_NODE, &cli_platform_show_system_watch_cmd);
+    install_element (ENABLE_NODE, &cli_platform_show_system_watch_interval_cmd);
+    install_element (VIEW_NODE, &cli_platform_show_system_watch_interval_cmd);
     install_element (VIEW_NODE, &vtysh_show_system_clock_cmd);
     install_element (ENABLE_NODE, &vtysh_show_system_clock_cmd);
+    install_element (VIEW_NODE, &vtysh_show_system_clock_format_cmd);
+    install_element (ENABLE_NODE, &vtysh_show_system_clock_format_cmd);
     install_element (VIEW_NODE, &vtysh_show_date_cmd);
     install_element (ENABLE_NODE, &vtysh_show_date_cmd);
+    install_element (VIEW_NODE, &vtysh_show_date_format_cmd);
+    install_element (ENABLE_NODE, &vtysh_show_date_format_cmd);
     install_element (VIEW_NODE, &vtysh_show_system_timezone_cmd);
     install_element (ENABLE_NODE, &vtysh_show_system_timezone_cmd);
 
@@ -40,6 +40,15 @@ VLOG_DEFINE_THIS_MODULE(qos_init);
 
 struct ovsdb_idl *idl;
 
+/**
+ * Returns true if the given optional hw_default column is set to true.
+ */
+static bool
+qos_is_hw_default(const bool *hw_default, size_t n_hw_default)
+{
+    return n_hw_default == 1 && hw_default[0];
+}
+
 /**
  * Returns true if the givien queue_row contains the local_priority.
  */
@@ -203,13 +212,92 @@ qos_queue_profile_row_command(struct ovsdb_idl_txn *txn,
     /* Update the queue row. */
     VLOG_INFO(".... updating %p", queue_row);
     add_local_priority(queue_row, local_priority);
-    if (description != NULL) {
+    if (description != NULL
+            && (queue_row->description == NULL
+                || strcmp(queue_row->description, description) != 0)) {
         ovsrec_q_profile_entry_set_description(queue_row, description);
     }
 
     return true;
 }
 
+/**
+ * Returns true if the hardware description maps local_priority to
+ * queue_num. A local_priority of -1 matches any local priority.
+ */
+static bool
+qos_yaml_queue_profile_has(int64_t queue_num, int64_t local_priority)
+{
+    const YamlQueueProfileEntry *yaml_queue_profile_entry;
+    int count = sysd_cfg_yaml_get_queue_profile_entry_count();
+    int ii;
+
+    for (ii = 0; ii < count; ii++) {
+        yaml_queue_profile_entry = sysd_cfg_yaml_get_queue_profile_entry(ii);
+        if (yaml_queue_profile_entry
+                && yaml_queue_profile_entry->queue == queue_num
+                && (local_priority < 0
+                    || yaml_queue_profile_entry->local_priority
+                       == local_priority)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Removes the queues and local priorities of the given profile_row that
+ * the hardware description no longer lists, so that a profile that
+ * already exists converges on the hardware description.
+ */
+static void
+qos_queue_profile_prune(struct ovsrec_q_profile *profile_row)
+{
+    int64_t *key_list =
+        xmalloc(sizeof(int64_t) * profile_row->n_q_profile_entries);
+    struct ovsrec_q_profile_entry **value_list =
+        xmalloc(sizeof*profile_row->value_q_profile_entries *
+                profile_row->n_q_profile_entries);
+    size_t n = 0;
+
+    int i;
+    for (i = 0; i < profile_row->n_q_profile_entries; i++) {
+        int64_t queue_num = profile_row->key_q_profile_entries[i];
+        struct ovsrec_q_profile_entry *queue_row =
+            profile_row->value_q_profile_entries[i];
+        if (!qos_yaml_queue_profile_has(queue_num, -1)) {
+            continue;
+        }
+        key_list[n] = queue_num;
+        value_list[n] = queue_row;
+        n++;
+
+        int64_t *priorities =
+            xmalloc(sizeof(int64_t) * queue_row->n_local_priorities);
+        size_t n_priorities = 0;
+        int j;
+        for (j = 0; j < queue_row->n_local_priorities; j++) {
+            if (qos_yaml_queue_profile_has(queue_num,
+                                           queue_row->local_priorities[j])) {
+                priorities[n_priorities++] = queue_row->local_priorities[j];
+            }
+        }
+        if (n_priorities != queue_row->n_local_priorities) {
+            ovsrec_q_profile_entry_set_local_priorities(queue_row, priorities,
+                                                        n_priorities);
+        }
+        free(priorities);
+    }
+
+    if (n != profile_row->n_q_profile_entries) {
+        ovsrec_q_profile_set_q_profile_entries(profile_row, key_list,
+                                               value_list, n);
+    }
+    free(key_list);
+    free(value_list);
+}
+
 /**
  * Creates the factory default queue profile for the given txn and
  * default_name.
@@ -223,6 +311,7 @@ qos_queue_profile_create_factory_default(struct ovsdb_idl_txn *txn,
     int count;
 
     qos_queue_profile_command(txn, default_name);
+    qos_queue_profile_prune(qos_get_queue_profile_row(default_name));
 
     count = sysd_cfg_yaml_get_queue_profile_entry_count();
     VLOG_DBG("THERE ARE %d QUEUE_PROFILE ENTRIES", count);
@@ -359,18 +448,75 @@ qos_schedule_profile_row_command(struct ovsdb_idl_txn *txn,
                 profile_row, queue_num, txn);
     }
 
-    ovsrec_queue_set_algorithm(queue_row, algorithm);
+    if (queue_row->algorithm == NULL
+            || strcmp(queue_row->algorithm, algorithm) != 0) {
+        ovsrec_queue_set_algorithm(queue_row, algorithm);
+    }
     /* TODO: can "strict" have weight set to 0? */
     if ( ! strcmp(algorithm, OVSREC_QUEUE_ALGORITHM_STRICT)) {
-        ovsrec_queue_set_weight(queue_row, NULL, 0);
+        if (queue_row->n_weight != 0) {
+            ovsrec_queue_set_weight(queue_row, NULL, 0);
+        }
     }
-    else {
+    else if (queue_row->n_weight != 1 || queue_row->weight[0] != weight) {
         ovsrec_queue_set_weight(queue_row, &weight, 1);
     }
 
     return true;
 }
 
+/**
+ * Returns true if the hardware description lists queue_num in the
+ * schedule profile.
+ */
+static bool
+qos_yaml_schedule_profile_has(int64_t queue_num)
+{
+    const YamlScheduleProfileEntry *yaml_schedule_profile_entry;
+    int count = sysd_cfg_yaml_get_schedule_profile_entry_count();
+    int ii;
+
+    for (ii = 0; ii < count; ii++) {
+        yaml_schedule_profile_entry =
+            sysd_cfg_yaml_get_schedule_profile_entry(ii);
+        if (yaml_schedule_profile_entry
+                && yaml_schedule_profile_entry->queue == queue_num) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Removes the queues of the given profile_row that the hardware
+ * description no longer lists.
+ */
+static void
+qos_schedule_profile_prune(struct ovsrec_qos *profile_row)
+{
+    int64_t *key_list =
+        xmalloc(sizeof(int64_t) * profile_row->n_queues);
+    struct ovsrec_queue **value_list =
+        xmalloc(sizeof*profile_row->value_queues * profile_row->n_queues);
+    size_t n = 0;
+
+    int i;
+    for (i = 0; i < profile_row->n_queues; i++) {
+        if (qos_yaml_schedule_profile_has(profile_row->key_queues[i])) {
+            key_list[n] = profile_row->key_queues[i];
+            value_list[n] = profile_row->value_queues[i];
+            n++;
+        }
+    }
+
+    if (n != profile_row->n_queues) {
+        ovsrec_qos_set_queues(profile_row, key_list, value_list, n);
+    }
+    free(key_list);
+    free(value_list);
+}
+
 /**
  * Creates the factory default schedule profile for the given txn and
  * default_name.
@@ -387,11 +533,11 @@ qos_schedule_profile_create_factory_default(struct ovsdb_idl_txn *txn,
 
     qos_schedule_profile_command(txn, default_name);
 
-    /* Delete all queue rows. */
+    /* Drop the queue rows that are no longer described. */
     profile_row = qos_get_schedule_profile_row(default_name);
-    ovsrec_qos_set_queues(profile_row, NULL, NULL, 0);
+    qos_schedule_profile_prune(profile_row);
 
-    /* Create all queue rows. */
+    /* Create or update all queue rows. */
     for (int ii = 0; ii < count; ii++) {
         yaml_schedule_profile_entry =
             sysd_cfg_yaml_get_schedule_profile_entry(ii);
@@ -420,8 +566,10 @@ qos_init_trust(struct ovsdb_idl_txn *txn,
         return;
     }
 
-    /* trust pointer could be NULL only if YAML init has failed. */
-    if (qos_info->trust) {
+    /* trust pointer could be NULL only if YAML init has failed. Trust is
+     * user configuration, so it is only seeded when it is missing. */
+    if (qos_info->trust
+            && smap_get(&system_row->qos_config, QOS_TRUST_KEY) == NULL) {
         smap_clone(&smap, &system_row->qos_config);
         smap_replace(&smap, QOS_TRUST_KEY, qos_info->trust);
         ovsrec_system_set_qos_config(system_row, &smap);
@@ -444,7 +592,18 @@ set_cos_map_entry(struct ovsrec_qos_cos_map_entry *cos_map_entry,
     ovsrec_qos_cos_map_entry_set_local_priority(cos_map_entry, local_priority);
     ovsrec_qos_cos_map_entry_set_color(cos_map_entry, color);
     ovsrec_qos_cos_map_entry_set_description(cos_map_entry, description);
+}
 
+/**
+ * Saves the factory defaults code_point, local_priority, color, and
+ * description in the hw_defaults of the given cos_map_entry, if they
+ * differ from what is saved there.
+ */
+static void
+set_cos_map_entry_hw_defaults(struct ovsrec_qos_cos_map_entry *cos_map_entry,
+                              int64_t code_point, int64_t local_priority,
+                              char *color, char *description)
+{
     char code_point_buffer[QOS_CLI_STRING_BUFFER_SIZE];
     snprintf(code_point_buffer, QOS_CLI_STRING_BUFFER_SIZE,
              "%" PRId64, code_point);
@@ -459,37 +618,33 @@ set_cos_map_entry(struct ovsrec_qos_cos_map_entry *cos_map_entry,
     smap_replace(&smap, QOS_DEFAULT_LOCAL_PRIORITY_KEY, local_priority_buffer);
     smap_replace(&smap, QOS_DEFAULT_COLOR_KEY, color);
     smap_replace(&smap, QOS_DEFAULT_DESCRIPTION_KEY, description);
-    ovsrec_qos_cos_map_entry_set_hw_defaults(cos_map_entry, &smap);
+    if (!smap_equal(&smap, &cos_map_entry->hw_defaults)) {
+        ovsrec_qos_cos_map_entry_set_hw_defaults(cos_map_entry, &smap);
+    }
     smap_destroy(&smap);
 }
 
 /**
- * Initializes the given default cos_map.
+ * Returns the cos_map_entry row of the given system_row for code_point.
  */
-static void
-qos_init_default_cos_map(struct ovsrec_qos_cos_map_entry **cos_map)
+static struct ovsrec_qos_cos_map_entry *
+qos_get_cos_map_entry_row(const struct ovsrec_system *system_row,
+                          int64_t code_point)
 {
-    const YamlCosMapEntry *yaml_cos_map_entry;
-    int count;
-
-    count = sysd_cfg_yaml_get_cos_map_entry_count();
-    VLOG_DBG("THERE ARE %d COS MAP ENTRIES", count);
-
-    /* Initialize the cos-map entry data. */
-    unsigned int ii;
-    for (ii = 0; ii < count; ii++) {
-        yaml_cos_map_entry = sysd_cfg_yaml_get_cos_map_entry(ii);
-        set_cos_map_entry(cos_map[ii],
-                          yaml_cos_map_entry->code_point,
-                          yaml_cos_map_entry->local_priority,
-                          yaml_cos_map_entry->color,
-                          yaml_cos_map_entry->description);
+    int i;
+    for (i = 0; i < system_row->n_qos_cos_map_entries; i++) {
+        if (system_row->qos_cos_map_entries[i]->code_point == code_point) {
+            return system_row->qos_cos_map_entries[i];
+        }
     }
+
+    return NULL;
 }
 
 /**
- * Creates cos_map rows and initializes them for the given txn and
- * system_row.
+ * Creates the missing cos_map rows and refreshes the factory defaults of
+ * all of them for the given txn and system_row. The actual config of an
+ * existing row belongs to the user and is left alone.
  */
 void
 qos_init_cos_map(struct ovsdb_idl_txn *txn,
@@ -501,27 +656,43 @@ qos_init_cos_map(struct ovsdb_idl_txn *txn,
         return;
     }
 
-    /* Create the cos-map rows. */
-    struct ovsrec_qos_cos_map_entry *cos_map_rows[QOS_COS_MAP_ENTRY_COUNT];
-    int i;
-    for (i = 0; i < QOS_COS_MAP_ENTRY_COUNT; i++) {
+    int count = MIN(sysd_cfg_yaml_get_cos_map_entry_count(),
+                    QOS_COS_MAP_ENTRY_COUNT);
+    VLOG_DBG("THERE ARE %d COS MAP ENTRIES", count);
+
+    struct ovsrec_qos_cos_map_entry **value_list = xmalloc(
+        sizeof*system_row->qos_cos_map_entries *
+        (system_row->n_qos_cos_map_entries + count));
+    size_t n = system_row->n_qos_cos_map_entries;
+    memcpy(value_list, system_row->qos_cos_map_entries,
+           sizeof*value_list * n);
+
+    int ii;
+    for (ii = 0; ii < count; ii++) {
+        yaml_cos_map_entry = sysd_cfg_yaml_get_cos_map_entry(ii);
         struct ovsrec_qos_cos_map_entry *cos_map_row =
-            ovsrec_qos_cos_map_entry_insert(txn);
-        cos_map_rows[i] = cos_map_row;
+            qos_get_cos_map_entry_row(system_row,
+                                      yaml_cos_map_entry->code_point);
+        if (cos_map_row == NULL) {
+            cos_map_row = ovsrec_qos_cos_map_entry_insert(txn);
+            set_cos_map_entry(cos_map_row,
+                              yaml_cos_map_entry->code_point,
+                              yaml_cos_map_entry->local_priority,
+                              yaml_cos_map_entry->color,
+                              yaml_cos_map_entry->description);
+            value_list[n++] = cos_map_row;
+        }
+        set_cos_map_entry_hw_defaults(cos_map_row,
+                                      yaml_cos_map_entry->code_point,
+                                      yaml_cos_map_entry->local_priority,
+                                      yaml_cos_map_entry->color,
+                                      yaml_cos_map_entry->description);
     }
 
-    /* Update the cos-map rows. */
-    qos_init_default_cos_map(cos_map_rows);
-
     /* Update the system row. */
-    struct ovsrec_qos_cos_map_entry **value_list = xmalloc(
-        sizeof*system_row->qos_cos_map_entries *
-        QOS_COS_MAP_ENTRY_COUNT);
-    for (i = 0; i < QOS_COS_MAP_ENTRY_COUNT; i++) {
-        value_list[i] = cos_map_rows[i];
+    if (n != system_row->n_qos_cos_map_entries) {
+        ovsrec_system_set_qos_cos_map_entries(system_row, value_list, n);
     }
-    ovsrec_system_set_qos_cos_map_entries(system_row, value_list,
-                                          QOS_COS_MAP_ENTRY_COUNT);
     free(value_list);
 }
 
@@ -551,7 +722,24 @@ set_dscp_map_entry(struct ovsrec_qos_dscp_map_entry *dscp_map_entry,
 #endif
     ovsrec_qos_dscp_map_entry_set_color(dscp_map_entry, color);
     ovsrec_qos_dscp_map_entry_set_description(dscp_map_entry, description);
+}
 
+/**
+ * Saves the factory defaults code_point, local_priority, color, and
+ * description in the hw_defaults of the given dscp_map_entry, if they
+ * differ from what is saved there.
+ */
+static void
+set_dscp_map_entry_hw_defaults(
+        struct ovsrec_qos_dscp_map_entry *dscp_map_entry,
+        int64_t code_point, int64_t local_priority,
+#ifdef QOS_CAPABILITY_DSCP_MAP_COS_REMARK_DISABLED
+    /* Disabled for dill. */
+#else
+        int64_t priority_code_point,
+#endif
+        char *color, char *description)
+{
     char code_point_buffer[QOS_CLI_STRING_BUFFER_SIZE];
     snprintf(code_point_buffer, QOS_CLI_STRING_BUFFER_SIZE,
              "%" PRId64, code_point);
@@ -580,43 +768,33 @@ set_dscp_map_entry(struct ovsrec_qos_dscp_map_entry *dscp_map_entry,
 #endif
     smap_replace(&smap, QOS_DEFAULT_COLOR_KEY, color);
     smap_replace(&smap, QOS_DEFAULT_DESCRIPTION_KEY, description);
-    ovsrec_qos_dscp_map_entry_set_hw_defaults(dscp_map_entry, &smap);
+    if (!smap_equal(&smap, &dscp_map_entry->hw_defaults)) {
+        ovsrec_qos_dscp_map_entry_set_hw_defaults(dscp_map_entry, &smap);
+    }
     smap_destroy(&smap);
 }
 
 /**
- * Initializes the given default dscp_map.
+ * Returns the dscp_map_entry row of the given system_row for code_point.
  */
-static void
-qos_init_default_dscp_map(
-        struct ovsrec_qos_dscp_map_entry **dscp_map)
+static struct ovsrec_qos_dscp_map_entry *
+qos_get_dscp_map_entry_row(const struct ovsrec_system *system_row,
+                           int64_t code_point)
 {
-    const YamlDscpMapEntry *yaml_dscp_map_entry;
-    int count;
-
-    count = sysd_cfg_yaml_get_dscp_map_entry_count();
-    VLOG_DBG("THERE ARE %d DSCP MAP ENTRIES", count);
-
-    /* Initialize the dscp-map entry data. */
-    unsigned int ii;
-    for (ii = 0; ii < count; ii++) {
-        yaml_dscp_map_entry = sysd_cfg_yaml_get_dscp_map_entry(ii);
-        set_dscp_map_entry(dscp_map[ii],
-                           yaml_dscp_map_entry->code_point,
-                           yaml_dscp_map_entry->local_priority,
-#ifdef QOS_CAPABILITY_DSCP_MAP_COS_REMARK_DISABLED
-    /* Disabled for dill. */
-#else
-                           yaml_dscp_map_entry->priority_code_point,
-#endif
-                           yaml_dscp_map_entry->color,
-                           yaml_dscp_map_entry->description);
+    int i;
+    for (i = 0; i < system_row->n_qos_dscp_map_entries; i++) {
+        if (system_row->qos_dscp_map_entries[i]->code_point == code_point) {
+            return system_row->qos_dscp_map_entries[i];
+        }
     }
+
+    return NULL;
 }
 
 /**
- * Creates and initializes the default dscp map for the given txn and
- * system_row.
+ * Creates the missing dscp_map rows and refreshes the factory defaults of
+ * all of them for the given txn and system_row. The actual config of an
+ * existing row belongs to the user and is left alone.
  */
 void
 qos_init_dscp_map(struct ovsdb_idl_txn *txn,
@@ -628,27 +806,53 @@ qos_init_dscp_map(struct ovsdb_idl_txn *txn,
         return;
     }
 
-    /* Create the dscp-map rows. */
-    struct ovsrec_qos_dscp_map_entry *dscp_map_rows[QOS_DSCP_MAP_ENTRY_COUNT];
-    int i;
-    for (i = 0; i < QOS_DSCP_MAP_ENTRY_COUNT; i++) {
+    int count = MIN(sysd_cfg_yaml_get_dscp_map_entry_count(),
+                    QOS_DSCP_MAP_ENTRY_COUNT);
+    VLOG_DBG("THERE ARE %d DSCP MAP ENTRIES", count);
+
+    struct ovsrec_qos_dscp_map_entry **value_list = xmalloc(
+        sizeof*system_row->qos_dscp_map_entries *
+        (system_row->n_qos_dscp_map_entries + count));
+    size_t n = system_row->n_qos_dscp_map_entries;
+    memcpy(value_list, system_row->qos_dscp_map_entries,
+           sizeof*value_list * n);
+
+    int ii;
+    for (ii = 0; ii < count; ii++) {
+        yaml_dscp_map_entry = sysd_cfg_yaml_get_dscp_map_entry(ii);
         struct ovsrec_qos_dscp_map_entry *dscp_map_row =
-            ovsrec_qos_dscp_map_entry_insert(txn);
-        dscp_map_rows[i] = dscp_map_row;
+            qos_get_dscp_map_entry_row(system_row,
+                                       yaml_dscp_map_entry->code_point);
+        if (dscp_map_row == NULL) {
+            dscp_map_row = ovsrec_qos_dscp_map_entry_insert(txn);
+            set_dscp_map_entry(dscp_map_row,
+                               yaml_dscp_map_entry->code_point,
+                               yaml_dscp_map_entry->local_priority,
+#ifdef QOS_CAPABILITY_DSCP_MAP_COS_REMARK_DISABLED
+    /* Disabled for dill. */
+#else
+                               yaml_dscp_map_entry->priority_code_point,
+#endif
+                               yaml_dscp_map_entry->color,
+                               yaml_dscp_map_entry->description);
+            value_list[n++] = dscp_map_row;
+        }
+        set_dscp_map_entry_hw_defaults(dscp_map_row,
+                                       yaml_dscp_map_entry->code_point,
+                                       yaml_dscp_map_entry->local_priority,
+#ifdef QOS_CAPABILITY_DSCP_MAP_COS_REMARK_DISABLED
+    /* Disabled for dill. */
+#else
+                                       yaml_dscp_map_entry->priority_code_point,
+#endif
+                                       yaml_dscp_map_entry->color,
+                                       yaml_dscp_map_entry->description);
     }
 
-    /* Update the dscp-map rows. */
-    qos_init_default_dscp_map(dscp_map_rows);
-
     /* Update the system row. */
-    struct ovsrec_qos_dscp_map_entry **value_list = xmalloc(
-        sizeof*system_row->qos_dscp_map_entries *
-        QOS_DSCP_MAP_ENTRY_COUNT);
-    for (i = 0; i < QOS_DSCP_MAP_ENTRY_COUNT; i++) {
-        value_list[i] = dscp_map_rows[i];
+    if (n != system_row->n_qos_dscp_map_entries) {
+        ovsrec_system_set_qos_dscp_map_entries(system_row, value_list, n);
     }
-    ovsrec_system_set_qos_dscp_map_entries(system_row, value_list,
-                                           QOS_DSCP_MAP_ENTRY_COUNT);
     free(value_list);
 }
 
@@ -664,8 +868,11 @@ qos_init_queue_profile(struct ovsdb_idl_txn *txn,
         return;
     }
 
-    /* Create the default profile. */
-    qos_queue_profile_create_factory_default(txn, qos_info->default_name);
+    /* Create the default profile. The default profile can be edited by
+     * the user, so an existing one is left alone. */
+    if (qos_get_queue_profile_row(qos_info->default_name) == NULL) {
+        qos_queue_profile_create_factory_default(txn, qos_info->default_name);
+    }
 
     struct ovsrec_q_profile *default_profile =
                     qos_get_queue_profile_row(qos_info->default_name);
@@ -674,8 +881,11 @@ qos_init_queue_profile(struct ovsdb_idl_txn *txn,
         return;
     }
 
-    /* Update the system row to point to the default profile. */
-    ovsrec_system_set_q_profile(system_row, default_profile);
+    /* Update the system row to point to the default profile, unless a
+     * profile has already been applied. */
+    if (system_row->q_profile == NULL) {
+        ovsrec_system_set_q_profile(system_row, default_profile);
+    }
 
     /* Also, create a profile named factory default that is immutable. */
     qos_queue_profile_create_factory_default(txn,
@@ -690,14 +900,19 @@ qos_init_queue_profile(struct ovsdb_idl_txn *txn,
 
     /* Set hw_default for profile row. */
     bool hw_default = true;
-    ovsrec_q_profile_set_hw_default(factory_default_profile, &hw_default, 1);
+    if (!qos_is_hw_default(factory_default_profile->hw_default,
+                           factory_default_profile->n_hw_default)) {
+        ovsrec_q_profile_set_hw_default(factory_default_profile, &hw_default, 1);
+    }
 
     /* Set hw_default for profile entry rows. */
     int i;
     for (i = 0; i < factory_default_profile->n_q_profile_entries; i++) {
         struct ovsrec_q_profile_entry *entry =
             factory_default_profile->value_q_profile_entries[i];
-        ovsrec_q_profile_entry_set_hw_default(entry, &hw_default, 1);
+        if (!qos_is_hw_default(entry->hw_default, entry->n_hw_default)) {
+            ovsrec_q_profile_entry_set_hw_default(entry, &hw_default, 1);
+        }
     }
 }
 
@@ -713,8 +928,12 @@ qos_init_schedule_profile(struct ovsdb_idl_txn *txn,
         return;
     }
 
-    /* Create the default profile. */
-    qos_schedule_profile_create_factory_default(txn, qos_info->default_name);
+    /* Create the default profile. The default profile can be edited by
+     * the user, so an existing one is left alone. */
+    if (qos_get_schedule_profile_row(qos_info->default_name) == NULL) {
+        qos_schedule_profile_create_factory_default(txn,
+                                                    qos_info->default_name);
+    }
 
     struct ovsrec_qos *default_profile =
         qos_get_schedule_profile_row(qos_info->default_name);
@@ -723,8 +942,11 @@ qos_init_schedule_profile(struct ovsdb_idl_txn *txn,
         return;
     }
 
-    /* Update the system row to point to the default profile. */
-    ovsrec_system_set_qos(system_row, default_profile);
+    /* Update the system row to point to the default profile, unless a
+     * profile has already been applied. */
+    if (system_row->qos == NULL) {
+        ovsrec_system_set_qos(system_row, default_profile);
+    }
 
     /* Also, create a profile named factory default that is immutable. */
     qos_schedule_profile_create_factory_default(txn,
@@ -739,13 +961,18 @@ qos_init_schedule_profile(struct ovsdb_idl_txn *txn,
 
     /* Set hw_default for profile row. */
     bool hw_default = true;
-    ovsrec_qos_set_hw_default(factory_default_profile, &hw_default, 1);
+    if (!qos_is_hw_default(factory_default_profile->hw_default,
+                           factory_default_profile->n_hw_default)) {
+        ovsrec_qos_set_hw_default(factory_default_profile, &hw_default, 1);
+    }
 
     /* Set hw_default for profile entry rows. */
     int i;
     for (i = 0; i < factory_default_profile->n_queues; i++) {
         struct ovsrec_queue *entry =
             factory_default_profile->value_queues[i];
-        ovsrec_queue_set_hw_default(entry, &hw_default, 1);
+        if (!qos_is_hw_default(entry->hw_default, entry->n_hw_default)) {
+            ovsrec_queue_set_hw_default(entry, &hw_default, 1);
+        }
     }
 }
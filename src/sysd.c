@@ -23,9 +23,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <getopt.h>
 
 #include <command-line.h>
+#include <coverage.h>
 #include <dirs.h>
 #include <smap.h>
 #include <poll-loop.h>
@@ -35,6 +37,8 @@
 #include <unixctl.h>
 #include <daemon.h>
 #include <fatal-signal.h>
+#include <memory.h>
+#include <simap.h>
 #include <dynamic-string.h>
 
 #include <ops-utils.h>
@@ -43,17 +47,21 @@
 #include "sysd.h"
 #include "sysd_util.h"
 #include "sysd_ovsdb_if.h"
+#include "sysd_readiness.h"
+#include "sysd_loop.h"
 
 #include "eventlog.h"
 #include "diag_dump.h"
 
 VLOG_DEFINE_THIS_MODULE(ops_sysd);
 
+COVERAGE_DEFINE(sysd_idl_changed_loop);
+
 /** @ingroup ops-sysd
  * @{ */
 
-#define BUF_LEN 16000
-#define MAX_ERR_STR_LEN 255
+/* diag-dump features with this suffix get the JSON dump. */
+#define SYSD_DIAG_DUMP_JSON_SUFFIX "-json"
 
 /* OVSDB IDL used to obtain configuration. */
 struct ovsdb_idl *idl;
@@ -63,10 +71,6 @@ sysd_subsystem_t **subsystems = NULL;
 
 char *g_hw_desc_dir = "/";
 
-daemon_info_t **daemons = NULL;
-int num_daemons = 0;
-int num_hw_daemons = 0;
-
 /* Structure to store management info read */
 mgmt_intf_info_t *mgmt_intf = NULL;
 
@@ -82,46 +86,108 @@ mgmt_intf_info_t *mgmt_intf = NULL;
 static void
 sysd_diag_dump_basic_cb(const char *feature , char **buf)
 {
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    bool json;
+
     if (!buf)
         return;
-    *buf =  xcalloc(1, BUF_LEN);
-    if (*buf) {
-        /* populate basic diagnostic data to buffer  */
-        sysd_dump(*buf, BUF_LEN);
-        VLOG_DBG("basic diag-dump data populated for feature %s",
-                feature);
-    } else{
-        VLOG_ERR("Memory allocation failed for feature %s, %d bytes",
-                feature, BUF_LEN);
-    }
+
+    /* A feature name ending in SYSD_DIAG_DUMP_JSON_SUFFIX selects the
+     * machine readable dump. */
+    json = (feature != NULL
+            && strlen(feature) >= strlen(SYSD_DIAG_DUMP_JSON_SUFFIX)
+            && !strcmp(feature + strlen(feature)
+                       - strlen(SYSD_DIAG_DUMP_JSON_SUFFIX),
+                       SYSD_DIAG_DUMP_JSON_SUFFIX));
+
+    /* populate basic diagnostic data to buffer  */
+    sysd_dump(&ds, json, 0, NULL);
+    *buf = ds_steal_cstr(&ds);
+    VLOG_DBG("basic diag-dump data populated for feature %s",
+             feature);
 }
 
-/* Dumps debug data for entire daemon */
+/* Dumps debug data for entire daemon, or only the sections in argv[1..].
+ * "--json" anywhere in the arguments selects JSON output. */
 static void
-sysd_unixctl_dump(struct unixctl_conn *conn, int argc OVS_UNUSED,
-                          const char *argv[] OVS_UNUSED, void *aux OVS_UNUSED)
+sysd_unixctl_dump(struct unixctl_conn *conn, int argc,
+                  const char *argv[], void *aux OVS_UNUSED)
 {
-    char err_str[MAX_ERR_STR_LEN];
-    char *buf = xcalloc(1, BUF_LEN);
-
-    /* Dump the daemon info */
-    if (buf){
-        strcpy(buf, "Support Dump for Platform SYS Daemon (ops-sysd)\n\n");
-        sysd_dump(buf, BUF_LEN);
-        unixctl_command_reply(conn, buf);
-        free(buf);
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    const char **sections;
+    int n_sections = 0;
+    bool json = false;
+    char *error;
+    int i;
+
+    sections = xmalloc(argc * sizeof *sections);
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--json")) {
+            json = true;
+        } else {
+            sections[n_sections++] = argv[i];
+        }
+    }
+
+    if (!json) {
+        ds_put_cstr(&ds,
+                    "Support Dump for Platform SYS Daemon (ops-sysd)\n\n");
+    }
+    error = sysd_dump(&ds, json, n_sections, sections);
+    if (error) {
+        unixctl_command_reply_error(conn, error);
+        free(error);
     } else {
-        snprintf(err_str, sizeof(err_str),
-                "sysd daemon failed to allocate %d bytes\n", BUF_LEN);
-        unixctl_command_reply(conn, err_str);
+        unixctl_command_reply(conn, ds_cstr(&ds));
     }
+    ds_destroy(&ds);
+    free(sections);
+
 } /* sysd_unixctl_dump */
 
+/* Reports the time each h/w daemon took to become ready */
+static void
+sysd_unixctl_readiness(struct unixctl_conn *conn, int argc OVS_UNUSED,
+                       const char *argv[] OVS_UNUSED, void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+
+    sysd_readiness_dump(&ds, &daemon_registry);
+    unixctl_command_reply(conn, ds_cstr(&ds));
+    ds_destroy(&ds);
+
+} /* sysd_unixctl_readiness */
+
+/* Reports where the main loop spends its time, optionally clearing it */
+static void
+sysd_unixctl_loop_stats(struct unixctl_conn *conn, int argc,
+                        const char *argv[], void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+
+    if (argc > 1) {
+        if (strcmp(argv[1], "clear")) {
+            unixctl_command_reply_error(conn, "usage: ops-sysd/loop-stats "
+                                        "[clear]");
+            return;
+        }
+        sysd_loop_clear();
+        unixctl_command_reply(conn, NULL);
+        return;
+    }
+
+    sysd_loop_dump(&ds);
+    unixctl_command_reply(conn, ds_cstr(&ds));
+    ds_destroy(&ds);
+
+} /* sysd_unixctl_loop_stats */
+
 static int
 sysd_get_subsystem_info(void)
 {
     int       i = 0;
     int       rc = 0;
+    size_t    fru_start;
 
     sysd_subsystem_t    *ptr;
 
@@ -132,21 +198,16 @@ sysd_get_subsystem_info(void)
 
     num_subsystems = 1;
 
-    subsystems = (sysd_subsystem_t **) calloc(num_subsystems, sizeof(sysd_subsystem_t *));
-    if (subsystems == (sysd_subsystem_t **)NULL) {
-        VLOG_ERR("Unable to allocate memory for subsystems, terminating");
-        return -1;
-    }
-
+    subsystems = sysd_arena_calloc(&sysd_boot_arena, num_subsystems,
+                                   sizeof *subsystems);
     for (i = 0; i < num_subsystems; i++) {
-        subsystems[i] = (sysd_subsystem_t *) calloc(1, sizeof(sysd_subsystem_t));
-        if (subsystems[i] == (sysd_subsystem_t *)NULL) {
-            VLOG_ERR("Unable to allocate memory for subsystems, terminating");
-            return -1;
-        }
+        subsystems[i] = sysd_subsystem_create();
     }
 
-    rc = sysd_read_fru_eeprom(&(subsystems[0]->fru_eeprom));
+    ptr = subsystems[0];
+    fru_start = ptr->arena.n_bytes;
+    rc = sysd_read_fru_eeprom(&(ptr->fru_eeprom), &ptr->arena);
+    ptr->fru_bytes = ptr->arena.n_bytes - fru_start;
     if (rc) {
         VLOG_ERR("Failed to read FRU data from base system.");
         log_event("SYS_FRU_DATA_READ_FAILURE", NULL);
@@ -154,7 +215,6 @@ sysd_get_subsystem_info(void)
     }
 
     /* Store information about BASE subsystem. */
-    ptr = subsystems[0];
     strncpy(ptr->name, SYSD_BASE_SUBSYSTEM, MAX_SUBSYSTEM_NAME_LEN);
     ptr->type = SYSD_SUBSYSTEM_TYPE_SYSTEM;
 
@@ -179,7 +239,72 @@ sysd_get_subsystem_info(void)
 
 } /* sysd_get_subsystem_info() */
 
-static int
+/* Returns a zeroed subsystem carved out of an arena of its own. */
+sysd_subsystem_t *
+sysd_subsystem_create(void)
+{
+    struct sysd_arena   arena;
+    sysd_subsystem_t    *subsystem;
+
+    sysd_arena_init(&arena, SYSD_SUBSYSTEM_ARENA_CHUNK);
+    subsystem = sysd_arena_alloc(&arena, sizeof *subsystem);
+    subsystem->arena = arena;
+
+    return subsystem;
+
+} /* sysd_subsystem_create */
+
+/* Frees 'subsystem' along with everything carved out of its arena. The
+ * parsed h/w description files it points into are not owned by it. */
+void
+sysd_subsystem_destroy(sysd_subsystem_t *subsystem)
+{
+    struct sysd_arena   arena;
+
+    if (subsystem == NULL) {
+        return;
+    }
+
+    free(subsystem->interfaces);
+
+    /* The arena header lives inside the memory it is about to free. */
+    arena = subsystem->arena;
+    sysd_arena_destroy(&arena);
+
+} /* sysd_subsystem_destroy */
+
+static void
+sysd_build_port_summary(sysd_subsystem_t *ptr)
+{
+    sysd_port_summary_t     *port;
+    const sysd_intf_info_t  *intf;
+    size_t                  start = ptr->arena.n_bytes;
+    int                     idx;
+
+    ptr->ports = sysd_arena_calloc(&ptr->arena, ptr->intf_count,
+                                   sizeof *ptr->ports);
+    for (idx = 0; idx < ptr->intf_count; idx++) {
+        intf = ptr->interfaces[idx];
+        port = &ptr->ports[idx];
+
+        port->name = sysd_arena_strdup(&ptr->arena, intf->name);
+        port->connector = sysd_arena_strdup(&ptr->arena, intf->connector);
+        port->parent_port = sysd_arena_strdup(&ptr->arena, intf->parent_port);
+        port->max_speed = intf->max_speed;
+        port->device = intf->device;
+        port->device_port = intf->device_port;
+        port->pluggable = intf->pluggable;
+    }
+    ptr->port_bytes = ptr->arena.n_bytes - start;
+
+} /* sysd_build_port_summary */
+
+/*
+ * Looks up the interfaces of the base subsystem in the h/w description
+ * files, reloading them if they were released. The first call also
+ * records the compact port summary.
+ */
+int
 sysd_get_interface_info(void)
 {
     int         idx = 0;
@@ -189,6 +314,12 @@ sysd_get_interface_info(void)
     sysd_intf_cmn_info_t        *intf_cmn_info = NULL;
     sysd_subsystem_t            *ptr;
 
+    /* OPS_TODO: Enhance the code to support multiple subsystems. */
+    ptr = subsystems[0];
+    if (ptr->interfaces != NULL) {
+        return 0;
+    }
+
     /* Get interface related global info. */
     intf_cmn_info = sysd_cfg_yaml_get_port_subsys_info();
     if (intf_cmn_info == (sysd_intf_cmn_info_t *)NULL) {
@@ -221,16 +352,38 @@ sysd_get_interface_info(void)
         }
     }
 
-    /* OPS_TODO: Enhance the code to support multiple subsystems. */
-    ptr = subsystems[0];
     ptr->intf_count = intf_count;
-    ptr->intf_cmn_info = intf_cmn_info;
+    ptr->intf_cmn = *intf_cmn_info;
+    ptr->intf_cmn_info = &ptr->intf_cmn;
     ptr->interfaces = interfaces;
 
+    if (ptr->ports == NULL) {
+        sysd_build_port_summary(ptr);
+    }
+
     return 0;
 
 } /* sysd_get_interface_info */
 
+/*
+ * Drops the per interface pointers into the parsed h/w description files
+ * and releases them. Only the compact port summary is kept; the files
+ * are parsed again by the next sysd_get_interface_info() call.
+ */
+void
+sysd_release_interface_info(void)
+{
+    int i;
+
+    for (i = 0; i < num_subsystems; i++) {
+        free(subsystems[i]->interfaces);
+        subsystems[i]->interfaces = NULL;
+    }
+
+    sysd_cfg_yaml_release();
+
+} /* sysd_release_interface_info */
+
 static int
 sysd_find_hw_desc_files(void)
 {
@@ -270,6 +423,28 @@ sysd_ovsdb_conn_init(char *remote)
     ovsdb_idl_omit_alert(idl, &ovsrec_system_col_switch_version);
     ovsdb_idl_add_column(idl, &ovsrec_system_col_timezone);
 
+    /* Columns compared by the warm restart reconciliation. */
+    ovsdb_idl_add_column(idl, &ovsrec_system_col_bridges);
+    ovsdb_idl_omit_alert(idl, &ovsrec_system_col_bridges);
+    ovsdb_idl_add_column(idl, &ovsrec_system_col_vrfs);
+    ovsdb_idl_omit_alert(idl, &ovsrec_system_col_vrfs);
+    ovsdb_idl_add_column(idl, &ovsrec_system_col_daemons);
+    ovsdb_idl_omit_alert(idl, &ovsrec_system_col_daemons);
+    ovsdb_idl_add_column(idl, &ovsrec_system_col_management_mac);
+    ovsdb_idl_omit_alert(idl, &ovsrec_system_col_management_mac);
+    ovsdb_idl_add_column(idl, &ovsrec_system_col_system_mac);
+    ovsdb_idl_omit_alert(idl, &ovsrec_system_col_system_mac);
+    ovsdb_idl_add_column(idl, &ovsrec_system_col_qos_config);
+    ovsdb_idl_omit_alert(idl, &ovsrec_system_col_qos_config);
+    ovsdb_idl_add_column(idl, &ovsrec_system_col_qos_cos_map_entries);
+    ovsdb_idl_omit_alert(idl, &ovsrec_system_col_qos_cos_map_entries);
+    ovsdb_idl_add_column(idl, &ovsrec_system_col_qos_dscp_map_entries);
+    ovsdb_idl_omit_alert(idl, &ovsrec_system_col_qos_dscp_map_entries);
+    ovsdb_idl_add_column(idl, &ovsrec_system_col_q_profile);
+    ovsdb_idl_omit_alert(idl, &ovsrec_system_col_q_profile);
+    ovsdb_idl_add_column(idl, &ovsrec_system_col_qos);
+    ovsdb_idl_omit_alert(idl, &ovsrec_system_col_qos);
+
     ovsdb_idl_add_table(idl, &ovsrec_table_subsystem);
     ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_name);
     ovsdb_idl_omit_alert(idl, &ovsrec_subsystem_col_name);
@@ -281,6 +456,12 @@ sysd_ovsdb_conn_init(char *remote)
     ovsdb_idl_omit_alert(idl, &ovsrec_subsystem_col_other_config);
     ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_interfaces);
     ovsdb_idl_omit_alert(idl, &ovsrec_subsystem_col_interfaces);
+    ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_other_info);
+    ovsdb_idl_omit_alert(idl, &ovsrec_subsystem_col_other_info);
+    ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_next_mac_address);
+    ovsdb_idl_omit_alert(idl, &ovsrec_subsystem_col_next_mac_address);
+    ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_macs_remaining);
+    ovsdb_idl_omit_alert(idl, &ovsrec_subsystem_col_macs_remaining);
 
     ovsdb_idl_add_table(idl, &ovsrec_table_interface);
     ovsdb_idl_add_column(idl, &ovsrec_interface_col_name);
@@ -291,6 +472,69 @@ sysd_ovsdb_conn_init(char *remote)
     ovsdb_idl_omit_alert(idl, &ovsrec_interface_col_type);
     ovsdb_idl_add_column(idl, &ovsrec_interface_col_user_config);
     ovsdb_idl_omit_alert(idl, &ovsrec_interface_col_user_config);
+    ovsdb_idl_add_column(idl, &ovsrec_interface_col_split_parent);
+    ovsdb_idl_omit_alert(idl, &ovsrec_interface_col_split_parent);
+    ovsdb_idl_add_column(idl, &ovsrec_interface_col_split_children);
+    ovsdb_idl_omit_alert(idl, &ovsrec_interface_col_split_children);
+
+    /* Default bridge and VRF */
+    ovsdb_idl_add_table(idl, &ovsrec_table_bridge);
+    ovsdb_idl_add_column(idl, &ovsrec_bridge_col_name);
+    ovsdb_idl_omit_alert(idl, &ovsrec_bridge_col_name);
+    ovsdb_idl_add_column(idl, &ovsrec_bridge_col_ports);
+    ovsdb_idl_omit_alert(idl, &ovsrec_bridge_col_ports);
+    ovsdb_idl_add_table(idl, &ovsrec_table_port);
+    ovsdb_idl_add_column(idl, &ovsrec_port_col_name);
+    ovsdb_idl_omit_alert(idl, &ovsrec_port_col_name);
+    ovsdb_idl_add_column(idl, &ovsrec_port_col_interfaces);
+    ovsdb_idl_omit_alert(idl, &ovsrec_port_col_interfaces);
+    ovsdb_idl_add_table(idl, &ovsrec_table_vrf);
+    ovsdb_idl_add_column(idl, &ovsrec_vrf_col_name);
+    ovsdb_idl_omit_alert(idl, &ovsrec_vrf_col_name);
+    ovsdb_idl_add_column(idl, &ovsrec_vrf_col_table_id);
+    ovsdb_idl_omit_alert(idl, &ovsrec_vrf_col_table_id);
+    ovsdb_idl_add_column(idl, &ovsrec_vrf_col_status);
+    ovsdb_idl_omit_alert(idl, &ovsrec_vrf_col_status);
+
+    /* QoS factory defaults */
+    ovsdb_idl_add_table(idl, &ovsrec_table_q_profile);
+    ovsdb_idl_add_column(idl, &ovsrec_q_profile_col_name);
+    ovsdb_idl_omit_alert(idl, &ovsrec_q_profile_col_name);
+    ovsdb_idl_add_column(idl, &ovsrec_q_profile_col_q_profile_entries);
+    ovsdb_idl_omit_alert(idl, &ovsrec_q_profile_col_q_profile_entries);
+    ovsdb_idl_add_column(idl, &ovsrec_q_profile_col_hw_default);
+    ovsdb_idl_omit_alert(idl, &ovsrec_q_profile_col_hw_default);
+    ovsdb_idl_add_table(idl, &ovsrec_table_q_profile_entry);
+    ovsdb_idl_add_column(idl, &ovsrec_q_profile_entry_col_local_priorities);
+    ovsdb_idl_omit_alert(idl, &ovsrec_q_profile_entry_col_local_priorities);
+    ovsdb_idl_add_column(idl, &ovsrec_q_profile_entry_col_description);
+    ovsdb_idl_omit_alert(idl, &ovsrec_q_profile_entry_col_description);
+    ovsdb_idl_add_column(idl, &ovsrec_q_profile_entry_col_hw_default);
+    ovsdb_idl_omit_alert(idl, &ovsrec_q_profile_entry_col_hw_default);
+    ovsdb_idl_add_table(idl, &ovsrec_table_qos);
+    ovsdb_idl_add_column(idl, &ovsrec_qos_col_name);
+    ovsdb_idl_omit_alert(idl, &ovsrec_qos_col_name);
+    ovsdb_idl_add_column(idl, &ovsrec_qos_col_queues);
+    ovsdb_idl_omit_alert(idl, &ovsrec_qos_col_queues);
+    ovsdb_idl_add_column(idl, &ovsrec_qos_col_hw_default);
+    ovsdb_idl_omit_alert(idl, &ovsrec_qos_col_hw_default);
+    ovsdb_idl_add_table(idl, &ovsrec_table_queue);
+    ovsdb_idl_add_column(idl, &ovsrec_queue_col_algorithm);
+    ovsdb_idl_omit_alert(idl, &ovsrec_queue_col_algorithm);
+    ovsdb_idl_add_column(idl, &ovsrec_queue_col_weight);
+    ovsdb_idl_omit_alert(idl, &ovsrec_queue_col_weight);
+    ovsdb_idl_add_column(idl, &ovsrec_queue_col_hw_default);
+    ovsdb_idl_omit_alert(idl, &ovsrec_queue_col_hw_default);
+    ovsdb_idl_add_table(idl, &ovsrec_table_qos_cos_map_entry);
+    ovsdb_idl_add_column(idl, &ovsrec_qos_cos_map_entry_col_code_point);
+    ovsdb_idl_omit_alert(idl, &ovsrec_qos_cos_map_entry_col_code_point);
+    ovsdb_idl_add_column(idl, &ovsrec_qos_cos_map_entry_col_hw_defaults);
+    ovsdb_idl_omit_alert(idl, &ovsrec_qos_cos_map_entry_col_hw_defaults);
+    ovsdb_idl_add_table(idl, &ovsrec_table_qos_dscp_map_entry);
+    ovsdb_idl_add_column(idl, &ovsrec_qos_dscp_map_entry_col_code_point);
+    ovsdb_idl_omit_alert(idl, &ovsrec_qos_dscp_map_entry_col_code_point);
+    ovsdb_idl_add_column(idl, &ovsrec_qos_dscp_map_entry_col_hw_defaults);
+    ovsdb_idl_omit_alert(idl, &ovsrec_qos_dscp_map_entry_col_hw_defaults);
 
     /* Daemon Table */
     ovsdb_idl_add_table(idl, &ovsrec_table_daemon);
@@ -403,6 +647,28 @@ parse_options(int argc, char *argv[], char **unixctl_pathp)
     }
 } /* parse_options */
 
+/* Releases the boot-time state once the main loop is done with it. */
+static void
+sysd_teardown(void)
+{
+    int i;
+
+    for (i = 0; i < num_subsystems; i++) {
+        sysd_subsystem_destroy(subsystems[i]);
+    }
+    subsystems = NULL;
+    num_subsystems = 0;
+    sysd_cfg_yaml_release();
+
+    sysd_daemon_registry_destroy(&daemon_registry);
+
+    /* Holds 'subsystems', 'mgmt_intf' and 'g_hw_desc_dir'. */
+    sysd_arena_destroy(&sysd_boot_arena);
+    mgmt_intf = NULL;
+    g_hw_desc_dir = "/";
+
+} /* sysd_teardown */
+
 static void
 sysd_exit(struct unixctl_conn *conn, int argc OVS_UNUSED,
                 const char *argv[] OVS_UNUSED, void *exiting_)
@@ -410,7 +676,6 @@ sysd_exit(struct unixctl_conn *conn, int argc OVS_UNUSED,
     bool *exiting = exiting_;
     *exiting = true;
     sysd_cfg_yaml_set_system_status_led(0);
-    free(subsystems);
     unixctl_command_reply(conn, NULL);
 
 } /* sysd_exit */
@@ -429,6 +694,9 @@ main(int argc, char *argv[])
     set_program_name(argv[0]);
     fatal_ignore_sigpipe();
 
+    /* Boot timings are measured from here. */
+    sysd_readiness_init();
+
     /* Parse commandline args and get the name of the OVSDB socket. */
     ovsdb_sock = parse_options(argc, argv, &appctl_path);
 
@@ -451,7 +719,12 @@ main(int argc, char *argv[])
     }
 
     /* Register ovs-appctl commands for this daemon. */
-    unixctl_command_register("ops-sysd/dump", "", 0, 0, sysd_unixctl_dump, NULL);
+    unixctl_command_register("ops-sysd/dump", "[--json] [section]...", 0,
+                             INT_MAX, sysd_unixctl_dump, NULL);
+    unixctl_command_register("ops-sysd/readiness", "", 0, 0,
+                             sysd_unixctl_readiness, NULL);
+    unixctl_command_register("ops-sysd/loop-stats", "[clear]", 0, 1,
+                             sysd_unixctl_loop_stats, NULL);
 
     /* Register the ovs-appctl "exit" command for this daemon. */
     unixctl_command_register("exit", "", 0, 0, sysd_exit, &exiting);
@@ -502,11 +775,34 @@ main(int argc, char *argv[])
     sysd_cfg_yaml_set_system_status_led(1);
 
     while (!exiting) {
+        bool spin;
+
+        sysd_loop_begin();
         sysd_run();
+        sysd_loop_phase_done(SYSD_LOOP_RUN);
         unixctl_server_run(appctl);
+        sysd_loop_phase_done(SYSD_LOOP_UNIXCTL);
+
+        /* memory_run() logs RSS growth past its thresholds; the sysd
+         * breakdown follows it and answers memory/show. */
+        memory_run();
+        if (memory_should_report()) {
+            struct simap usage;
+
+            simap_init(&usage);
+            sysd_get_memory_usage(&usage);
+            memory_report(&usage);
+            simap_destroy(&usage);
+        }
+
         sysd_wait();
         unixctl_server_wait(appctl);
-        if (idl_seqno != ovsdb_idl_get_seqno(idl)) {
+        memory_wait();
+        sysd_loop_phase_done(SYSD_LOOP_WAIT);
+
+        spin = (idl_seqno != ovsdb_idl_get_seqno(idl));
+        sysd_loop_end(spin || exiting);
+        if (spin) {
             /* IDL seqno could have changed because of the ovsdb_idl_run()
              * called from the ovsdb_idl_txn_commit_block() calls inside
              * sysd. This could happen when DB transactions get posted
@@ -515,6 +811,7 @@ main(int argc, char *argv[])
              * status and could cause the poll_block() below to wait
              * until the next DB transaction happened, if any at all..
              */
+            COVERAGE_INC(sysd_idl_changed_loop);
             VLOG_ERR("IDL has changed. Continue to see what changed..");
         } else if (exiting) {
             poll_immediate_wake();
@@ -523,6 +820,8 @@ main(int argc, char *argv[])
         }
     }
 
+    sysd_teardown();
+
     return 0;
 
 } /* main */
@@ -0,0 +1,170 @@
+/************************************************************************//**
+ * (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *    License for the specific language governing permissions and limitations
+ *    under the License.
+ *
+ ***************************************************************************/
+/* @ingroup sysd
+ *
+ * @file
+ * Source for the sysd arena allocator.
+ *
+ * sysd builds most of its state once at boot and keeps it until it exits
+ * or, for a subsystem, until the subsystem goes away. Carving those small
+ * objects out of a few chunks avoids a malloc header per string and lets
+ * the owner drop everything with one call instead of walking each
+ * structure to free its fields.
+ *
+ * Allocations larger than a quarter of the chunk size get a chunk of
+ * their own, which is linked behind the current chunk so that the space
+ * left in it is still used by later small allocations.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <util.h>
+
+#include "sysd_arena.h"
+
+/** @ingroup sysd
+ * @{ */
+
+struct sysd_arena_chunk {
+    struct sysd_arena_chunk *next;
+    size_t                  size;       /* Usable bytes in 'data'. */
+    size_t                  used;
+    union {
+        long long int       ll;
+        long double         ld;
+        void                *p;
+    } data[];
+};
+
+#define SYSD_ARENA_ALIGN    (sizeof ((struct sysd_arena_chunk *) 0)->data[0])
+
+struct sysd_arena sysd_boot_arena = SYSD_ARENA_INITIALIZER;
+
+void
+sysd_arena_init(struct sysd_arena *arena, size_t chunk_size)
+{
+    arena->chunks = NULL;
+    arena->chunk_size = chunk_size;
+    arena->n_bytes = 0;
+    arena->allocated = 0;
+
+} /* sysd_arena_init */
+
+/* Frees every object carved out of 'arena'. The arena is left empty and
+ * may be used again. */
+void
+sysd_arena_destroy(struct sysd_arena *arena)
+{
+    struct sysd_arena_chunk *chunk, *next;
+
+    for (chunk = arena->chunks; chunk != NULL; chunk = next) {
+        next = chunk->next;
+        free(chunk);
+    }
+    arena->chunks = NULL;
+    arena->n_bytes = 0;
+    arena->allocated = 0;
+
+} /* sysd_arena_destroy */
+
+static struct sysd_arena_chunk *
+sysd_arena_new_chunk(struct sysd_arena *arena, size_t size)
+{
+    struct sysd_arena_chunk *chunk;
+
+    chunk = xmalloc(sizeof *chunk + size);
+    chunk->size = size;
+    chunk->used = 0;
+    arena->allocated += sizeof *chunk + size;
+
+    return chunk;
+
+} /* sysd_arena_new_chunk */
+
+/* Returns 'size' bytes of zeroed memory from 'arena', aligned for any
+ * type. The memory stays valid until the arena is destroyed. */
+void *
+sysd_arena_alloc(struct sysd_arena *arena, size_t size)
+{
+    struct sysd_arena_chunk *chunk = arena->chunks;
+    size_t                  chunk_size;
+    void                    *p;
+
+    chunk_size = arena->chunk_size ? arena->chunk_size
+                                   : SYSD_ARENA_DEFAULT_CHUNK;
+    size = ROUND_UP(MAX(size, 1), SYSD_ARENA_ALIGN);
+
+    if (chunk == NULL || chunk->size - chunk->used < size) {
+        if (size > chunk_size / 4) {
+            chunk = sysd_arena_new_chunk(arena, size);
+            if (arena->chunks != NULL) {
+                chunk->next = arena->chunks->next;
+                arena->chunks->next = chunk;
+            } else {
+                chunk->next = NULL;
+                arena->chunks = chunk;
+            }
+        } else {
+            chunk = sysd_arena_new_chunk(arena, chunk_size);
+            chunk->next = arena->chunks;
+            arena->chunks = chunk;
+        }
+    }
+
+    p = (char *) chunk->data + chunk->used;
+    chunk->used += size;
+    arena->n_bytes += size;
+    memset(p, 0, size);
+
+    return p;
+
+} /* sysd_arena_alloc */
+
+void *
+sysd_arena_calloc(struct sysd_arena *arena, size_t n, size_t size)
+{
+    if (size && n > SIZE_MAX / size) {
+        out_of_memory();
+    }
+
+    return sysd_arena_alloc(arena, n * size);
+
+} /* sysd_arena_calloc */
+
+/* Copies the first 'len' bytes of 'data' into 'arena' and adds a null
+ * terminator. */
+char *
+sysd_arena_memdup0(struct sysd_arena *arena, const void *data, size_t len)
+{
+    char    *p = sysd_arena_alloc(arena, len + 1);
+
+    memcpy(p, data, len);
+
+    return p;
+
+} /* sysd_arena_memdup0 */
+
+/* Returns a copy of 'str' in 'arena', or NULL if 'str' is NULL. */
+char *
+sysd_arena_strdup(struct sysd_arena *arena, const char *str)
+{
+    return str ? sysd_arena_memdup0(arena, str, strlen(str)) : NULL;
+
+} /* sysd_arena_strdup */
+/** @} end of group sysd */
@@ -28,11 +28,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <util.h>
 #include <openvswitch/vlog.h>
 
 #include <config-yaml.h>
 #include "sysd.h"
 #include "sysd_cfg_yaml.h"
+#include "sysd_arena.h"
 #include "string.h"
 #include "eventlog.h"
 
@@ -43,32 +45,56 @@ VLOG_DEFINE_THIS_MODULE(cfg_yaml);
 
 #define FRU_EEPROM_NAME "fru_eeprom"
 
+/* The parsed h/w description files. They are released once the initial
+ * configuration is committed (see sysd_cfg_yaml_release()) and parsed
+ * again from 'cfg_yaml_dir' by the first accessor that needs them. */
 static YamlConfigHandle cfg_yaml_handle = (YamlConfigHandle *)NULL;
-static const YamlDevice *fru_dev = NULL;
+static char *cfg_yaml_dir = NULL;
 bool fru_yaml = true;
 
-bool
-sysd_cfg_yaml_open(char *hw_desc_dir)
+/* The device descriptions alone, parsed and initialized once at boot and
+ * kept for the life of sysd: the FRU EEPROM and the status LED are
+ * accessed through them, and devices must not be initialized twice. */
+static YamlConfigHandle cfg_dev_handle = (YamlConfigHandle *)NULL;
+static const YamlDevice *fru_dev = NULL;
+
+/* Status LED register and values, from the device descriptions. 'reg' is
+ * NULL on platforms without a status LED. */
+static struct {
+    i2c_bit_op          *reg;
+    int                 on;
+    int                 flashing;
+} status_led;
+
+/* Returns a new handle for the h/w description files in 'hw_desc_dir', or
+ * NULL on failure. */
+static YamlConfigHandle
+sysd_cfg_yaml_open(const char *hw_desc_dir)
 {
+    YamlConfigHandle handle;
     int rc = 0;
 
-    cfg_yaml_handle = yaml_new_config_handle();
+    handle = yaml_new_config_handle();
 
-    rc = yaml_add_subsystem(cfg_yaml_handle, BASE_SUBSYSTEM, hw_desc_dir);
+    rc = yaml_add_subsystem(handle, BASE_SUBSYSTEM, hw_desc_dir);
     if (rc) {
         VLOG_ERR("Unable to create '%s' subsystem (yaml parsing).", BASE_SUBSYSTEM);
-        return(false);
+        yaml_free_config_handle(handle);
+        return NULL;
     }
 
-    return(true);
+    return handle;
 } /* sysd_cfg_yaml_open */
 
-bool
-sysd_cfg_yaml_init(char *hw_desc_dir)
+/* Parses the h/w description files sysd reads at boot and again after a
+ * release. Devices are not initialized here, see sysd_cfg_yaml_init(). */
+static bool
+sysd_cfg_yaml_parse(const char *hw_desc_dir)
 {
     int rc = 0;
 
-    if (!sysd_cfg_yaml_open(hw_desc_dir)) {
+    cfg_yaml_handle = sysd_cfg_yaml_open(hw_desc_dir);
+    if (!cfg_yaml_handle) {
         return(false);
     }
 
@@ -93,60 +119,138 @@ sysd_cfg_yaml_init(char *hw_desc_dir)
         return (false);
     }
 
-    rc = yaml_parse_qos(cfg_yaml_handle, BASE_SUBSYSTEM);
-    if (0 > rc) {
+    if (yaml_parse_qos(cfg_yaml_handle, BASE_SUBSYSTEM) < 0) {
         VLOG_ERR("Unable to parse qos yaml config file.");
     }
+    if (yaml_parse_acl(cfg_yaml_handle, BASE_SUBSYSTEM) < 0) {
+        VLOG_ERR("Unable to parse acl yaml config file.");
+    }
+
+    return (true);
+
+} /* sysd_cfg_yaml_parse */
+
+/* Returns the parsed h/w description files, parsing them again if they
+ * were released, or NULL on failure. */
+static YamlConfigHandle
+sysd_cfg_yaml_handle(void)
+{
+    if (cfg_yaml_handle == NULL && cfg_yaml_dir != NULL) {
+        VLOG_INFO("Reloading h/w description files from %s", cfg_yaml_dir);
+        if (!sysd_cfg_yaml_parse(cfg_yaml_dir)) {
+            sysd_cfg_yaml_release();
+        }
+    }
+
+    return cfg_yaml_handle;
+
+} /* sysd_cfg_yaml_handle */
+
+/*
+ * Frees the parsed h/w description files. Pointers previously returned
+ * by the accessors below become invalid; the next accessor call parses
+ * the files again. The device descriptions are kept.
+ */
+void
+sysd_cfg_yaml_release(void)
+{
+    if (cfg_yaml_handle != NULL) {
+        yaml_free_config_handle(cfg_yaml_handle);
+        cfg_yaml_handle = NULL;
+        VLOG_INFO("Released h/w description files");
+    }
+
+} /* sysd_cfg_yaml_release */
+
+/* Parses and initializes the devices in 'hw_desc_dir' into
+ * 'cfg_dev_handle', and looks up the FRU EEPROM and the status LED. */
+static bool
+sysd_cfg_yaml_init_devices(const char *hw_desc_dir)
+{
+    const YamlSystemLedInfo *system_led;
+    int rc = 0;
+
+    cfg_dev_handle = sysd_cfg_yaml_open(hw_desc_dir);
+    if (!cfg_dev_handle) {
+        return (false);
+    }
 
-    rc = yaml_parse_acl(cfg_yaml_handle, BASE_SUBSYSTEM);
+    rc = yaml_parse_devices(cfg_dev_handle, BASE_SUBSYSTEM);
     if (0 > rc) {
-        VLOG_ERR("Unable to parse acl yaml config file.");
+        VLOG_ERR("Unable to parse devices yaml config file.");
+        return (false);
     }
 
-    rc = yaml_init_devices(cfg_yaml_handle, BASE_SUBSYSTEM);
+    rc = yaml_init_devices(cfg_dev_handle, BASE_SUBSYSTEM);
     if (0 > rc) {
         VLOG_ERR("Failed to intialize devices");
         log_event("SYS_INITIALIZE_DEVICE_FAILURE", NULL);
         return (false);
     }
-    fru_dev = yaml_find_device(cfg_yaml_handle, BASE_SUBSYSTEM, FRU_EEPROM_NAME);
+    fru_dev = yaml_find_device(cfg_dev_handle, BASE_SUBSYSTEM, FRU_EEPROM_NAME);
     if (fru_dev == (YamlDevice *)NULL) {
         VLOG_ERR("unable to find device %s in YAML description.", FRU_EEPROM_NAME);
         return (false);
     }
 
+    system_led = yaml_get_system_led_info(cfg_dev_handle, BASE_SUBSYSTEM);
+    if (system_led && system_led->status_led) {
+        status_led.reg = system_led->status_led;
+        status_led.on = system_led->status_led_settings.on;
+        status_led.flashing = system_led->status_led_settings.flashing;
+    }
+
     return (true);
 
+} /* sysd_cfg_yaml_init_devices */
+
+bool
+sysd_cfg_yaml_init(char *hw_desc_dir)
+{
+    free(cfg_yaml_dir);
+    cfg_yaml_dir = xstrdup(hw_desc_dir);
+
+    return sysd_cfg_yaml_init_devices(hw_desc_dir)
+           && sysd_cfg_yaml_parse(hw_desc_dir);
+
 } /* sysd_cfg_yaml_init */
 
 int
 sysd_cfg_yaml_get_port_count(void)
 {
-    return (int) yaml_get_port_count(cfg_yaml_handle, BASE_SUBSYSTEM);
+    YamlConfigHandle handle = sysd_cfg_yaml_handle();
+
+    return handle ? (int) yaml_get_port_count(handle, BASE_SUBSYSTEM) : 0;
 
 } /* sysd_cfg_yaml_get_port_count */
 
 YamlPort *
 sysd_cfg_yaml_get_port_info(int index)
 {
-    return (YamlPort *) yaml_get_port(cfg_yaml_handle, BASE_SUBSYSTEM, index);
+    YamlConfigHandle handle = sysd_cfg_yaml_handle();
+
+    return handle ? (YamlPort *) yaml_get_port(handle, BASE_SUBSYSTEM, index)
+                  : NULL;
 
 } /* sysd_cfg_yaml_get_port_info */
 
 YamlPortInfo *
 sysd_cfg_yaml_get_port_subsys_info(void)
 {
-    return yaml_get_port_info(cfg_yaml_handle, BASE_SUBSYSTEM);
+    YamlConfigHandle handle = sysd_cfg_yaml_handle();
+
+    return handle ? yaml_get_port_info(handle, BASE_SUBSYSTEM) : NULL;
 
 } /* sysd_cfg_yaml_get_port_subsys_info */
 
 int
-sysd_cfg_yaml_get_fru_info(fru_eeprom_t *fru_eeprom)
+sysd_cfg_yaml_get_fru_info(fru_eeprom_t *fru_eeprom,
+                           struct sysd_arena *arena)
 {
-    const YamlFruInfo *fru_info = yaml_get_fru_info(cfg_yaml_handle, BASE_SUBSYSTEM);
-    struct timespec tp;
-    unsigned int nsec_low;
+    YamlConfigHandle handle = sysd_cfg_yaml_handle();
+    const YamlFruInfo *fru_info;
 
+    fru_info = handle ? yaml_get_fru_info(handle, BASE_SUBSYSTEM) : NULL;
     if (!fru_info) {
        return -1;
     }
@@ -154,39 +258,39 @@ sysd_cfg_yaml_get_fru_info(fru_eeprom_t *fru_eeprom)
     strncpy(fru_eeprom->country_code, fru_info->country_code,
                                        FRU_COUNTRY_CODE_LEN);
     fru_eeprom->country_code[FRU_COUNTRY_CODE_LEN] = '\0';
-    fru_eeprom->diag_version = fru_info->diag_version;
-    fru_eeprom->label_revision = fru_info->label_revision;
-    sscanf(fru_info->base_mac_address, "%x:%x:%x:%x:%x:%x",
-       (unsigned int *) &fru_eeprom->base_mac_address[0],
-       (unsigned int *) &fru_eeprom->base_mac_address[1],
-       (unsigned int *) &fru_eeprom->base_mac_address[2],
-       (unsigned int *) &fru_eeprom->base_mac_address[3],
-       (unsigned int *) &fru_eeprom->base_mac_address[4],
-       (unsigned int *) &fru_eeprom->base_mac_address[5]
+    /* The strings are copied into the subsystem's arena: the parsed files
+     * may be released later. */
+    fru_eeprom->diag_version =
+        sysd_arena_strdup(arena, fru_info->diag_version);
+    fru_eeprom->label_revision =
+        sysd_arena_strdup(arena, fru_info->label_revision);
+    sscanf(fru_info->base_mac_address, "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
+       &fru_eeprom->base_mac_address[0],
+       &fru_eeprom->base_mac_address[1],
+       &fru_eeprom->base_mac_address[2],
+       &fru_eeprom->base_mac_address[3],
+       &fru_eeprom->base_mac_address[4],
+       &fru_eeprom->base_mac_address[5]
     );
-    /*
-     * Generate a random mac address everytime for vsi
-     * To have some sane values, use rand to generate
-     * only the last 24 bits
-     */
-    clock_gettime(CLOCK_MONOTONIC, &tp);
-    nsec_low = (unsigned int) (tp.tv_nsec & 0x00000000FFFFFFFF);
-    srand(nsec_low);
-    fru_eeprom->base_mac_address[3] = rand() & 0xff;
-    fru_eeprom->base_mac_address[4] = rand() & 0xff;
-    fru_eeprom->base_mac_address[5] = rand() & 0xff;
+    /* The NIC specific part of the base MAC is filled in by
+     * sysd_read_fru_eeprom(), see sysd_fru_set_yaml_base_mac(). */
     strncpy(fru_eeprom->manufacture_date, fru_info->manufacture_date,
             FRU_MANUFACTURE_DATE_LEN);
     fru_eeprom->manufacture_date[FRU_MANUFACTURE_DATE_LEN] = '\0';
-    fru_eeprom->manufacturer = fru_info->manufacturer;
+    fru_eeprom->manufacturer =
+        sysd_arena_strdup(arena, fru_info->manufacturer);
     fru_eeprom->num_macs = fru_info->num_macs;
-    fru_eeprom->onie_version = fru_info->onie_version;
-    fru_eeprom->part_number = fru_info->part_number;
-    fru_eeprom->platform_name = fru_info->platform_name;
-    fru_eeprom->product_name = fru_info->product_name;
-    fru_eeprom->serial_number = fru_info->serial_number;
-    fru_eeprom->service_tag = fru_info->service_tag;
-    fru_eeprom->vendor = fru_info->vendor;
+    fru_eeprom->onie_version =
+        sysd_arena_strdup(arena, fru_info->onie_version);
+    fru_eeprom->part_number = sysd_arena_strdup(arena, fru_info->part_number);
+    fru_eeprom->platform_name =
+        sysd_arena_strdup(arena, fru_info->platform_name);
+    fru_eeprom->product_name =
+        sysd_arena_strdup(arena, fru_info->product_name);
+    fru_eeprom->serial_number =
+        sysd_arena_strdup(arena, fru_info->serial_number);
+    fru_eeprom->service_tag = sysd_arena_strdup(arena, fru_info->service_tag);
+    fru_eeprom->vendor = sysd_arena_strdup(arena, fru_info->vendor);
     return 0;
 
 } /* sysd_cfg_yaml_get_fru_info  */
@@ -196,7 +300,12 @@ sysd_cfg_yaml_fru_read(unsigned char *fru_hdr, int hdr_len)
 {
     int         rc;
 
-    rc = i2c_data_read(cfg_yaml_handle, fru_dev, BASE_SUBSYSTEM, 0, hdr_len, fru_hdr);
+    if (cfg_dev_handle == NULL || fru_dev == NULL) {
+        VLOG_ERR("FRU EEPROM read before the devices were initialized.");
+        return (false);
+    }
+
+    rc = i2c_data_read(cfg_dev_handle, fru_dev, BASE_SUBSYSTEM, 0, hdr_len, fru_hdr);
     if (0 != rc) {
         VLOG_ERR("Failed to read FRU header.");
         log_event("SYS_FRU_HEADER_READ_FAILURE", NULL);
@@ -210,72 +319,100 @@ sysd_cfg_yaml_fru_read(unsigned char *fru_hdr, int hdr_len)
 YamlQosInfo *
 sysd_cfg_yaml_get_qos_info(void)
 {
-    return yaml_get_qos_info(cfg_yaml_handle, BASE_SUBSYSTEM);
+    YamlConfigHandle handle = sysd_cfg_yaml_handle();
+
+    return handle ? yaml_get_qos_info(handle, BASE_SUBSYSTEM) : NULL;
 }
 
 int
 sysd_cfg_yaml_get_cos_map_entry_count(void)
 {
-    return yaml_get_cos_map_entry_count(cfg_yaml_handle, BASE_SUBSYSTEM);
+    YamlConfigHandle handle = sysd_cfg_yaml_handle();
+
+    return handle ? yaml_get_cos_map_entry_count(handle, BASE_SUBSYSTEM) : 0;
 }
 
 const YamlCosMapEntry *
 sysd_cfg_yaml_get_cos_map_entry(unsigned int idx)
 {
-    return yaml_get_cos_map_entry(cfg_yaml_handle, BASE_SUBSYSTEM, idx);
+    YamlConfigHandle handle = sysd_cfg_yaml_handle();
+
+    return handle ? yaml_get_cos_map_entry(handle, BASE_SUBSYSTEM, idx) : NULL;
 }
 
 int
 sysd_cfg_yaml_get_dscp_map_entry_count(void)
 {
-    return yaml_get_dscp_map_entry_count(cfg_yaml_handle, BASE_SUBSYSTEM);
+    YamlConfigHandle handle = sysd_cfg_yaml_handle();
+
+    return handle ? yaml_get_dscp_map_entry_count(handle, BASE_SUBSYSTEM) : 0;
 }
 
 const YamlDscpMapEntry *
 sysd_cfg_yaml_get_dscp_map_entry(unsigned int idx)
 {
-    return yaml_get_dscp_map_entry(cfg_yaml_handle, BASE_SUBSYSTEM, idx);
+    YamlConfigHandle handle = sysd_cfg_yaml_handle();
+
+    return handle ? yaml_get_dscp_map_entry(handle, BASE_SUBSYSTEM, idx)
+                  : NULL;
 }
 
 int
 sysd_cfg_yaml_get_schedule_profile_entry_count(void)
 {
-    return yaml_get_schedule_profile_entry_count(cfg_yaml_handle, BASE_SUBSYSTEM);
+    YamlConfigHandle handle = sysd_cfg_yaml_handle();
+
+    return handle ? yaml_get_schedule_profile_entry_count(handle,
+                                                          BASE_SUBSYSTEM)
+                  : 0;
 }
 
 const YamlScheduleProfileEntry *
 sysd_cfg_yaml_get_schedule_profile_entry(unsigned int idx)
 {
-    return yaml_get_schedule_profile_entry(cfg_yaml_handle, BASE_SUBSYSTEM, idx);
+    YamlConfigHandle handle = sysd_cfg_yaml_handle();
+
+    return handle ? yaml_get_schedule_profile_entry(handle, BASE_SUBSYSTEM,
+                                                    idx)
+                  : NULL;
 }
 
 int
 sysd_cfg_yaml_get_queue_profile_entry_count(void)
 {
-    return yaml_get_queue_profile_entry_count(cfg_yaml_handle, BASE_SUBSYSTEM);
+    YamlConfigHandle handle = sysd_cfg_yaml_handle();
+
+    return handle ? yaml_get_queue_profile_entry_count(handle, BASE_SUBSYSTEM)
+                  : 0;
 }
 
 const YamlQueueProfileEntry *
 sysd_cfg_yaml_get_queue_profile_entry(unsigned int idx)
 {
-    return yaml_get_queue_profile_entry(cfg_yaml_handle, BASE_SUBSYSTEM, idx);
+    YamlConfigHandle handle = sysd_cfg_yaml_handle();
+
+    return handle ? yaml_get_queue_profile_entry(handle, BASE_SUBSYSTEM, idx)
+                  : NULL;
 }
 
 YamlAclInfo *
 sysd_cfg_yaml_get_acl_info(void)
 {
-    return yaml_get_acl_info(cfg_yaml_handle, BASE_SUBSYSTEM);
+    YamlConfigHandle handle = sysd_cfg_yaml_handle();
+
+    return handle ? yaml_get_acl_info(handle, BASE_SUBSYSTEM) : NULL;
 }
 
+/* Sets the status LED from the values kept at boot, without the parsed
+ * h/w description files. */
 void
 sysd_cfg_yaml_set_system_status_led(int good)
 {
-    const YamlSystemLedInfo *system_led;
-    system_led = yaml_get_system_led_info(cfg_yaml_handle, BASE_SUBSYSTEM);
-    if (system_led && system_led->status_led) {
-        i2c_reg_write(cfg_yaml_handle, BASE_SUBSYSTEM, system_led->status_led,
-                      good ? system_led->status_led_settings.on :
-                             system_led->status_led_settings.flashing);
+    if (cfg_dev_handle == NULL || status_led.reg == NULL) {
+        return;
     }
+
+    i2c_reg_write(cfg_dev_handle, BASE_SUBSYSTEM, status_led.reg,
+                  good ? status_led.on : status_led.flashing);
 }
 /** @} end of group sysd */
@@ -0,0 +1,395 @@
+/************************************************************************//**
+ * (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *    License for the specific language governing permissions and limitations
+ *    under the License.
+ *
+ ***************************************************************************/
+/* @ingroup sysd
+ *
+ * @file
+ * Source for the sysd daemon registry.
+ *
+ * The registry holds one daemon_info_t per daemon listed in the
+ * image.manifest file. Entries live in a single array that grows
+ * geometrically and are indexed by an hmap on the exact daemon name, so
+ * parsing a manifest with many daemons does not realloc per entry and
+ * lookups do not scan the array.
+ *
+ * Daemons may also name the daemons they depend on and the readiness
+ * stage they belong to. The dependencies form a DAG that is checked for
+ * cycles once the manifest has been read, and is then evaluated in
+ * topological order every time the Daemon table changes.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <util.h>
+#include <hash.h>
+#include <hmap.h>
+#include <simap.h>
+#include <ovsdb-idl.h>
+#include <vswitch-idl.h>
+#include <openvswitch/vlog.h>
+
+#include "sysd_daemon.h"
+
+VLOG_DEFINE_THIS_MODULE(sysd_daemon);
+
+/** @ingroup sysd
+ * @{ */
+
+sysd_daemon_registry_t daemon_registry = {
+    .by_name = HMAP_INITIALIZER(&daemon_registry.by_name),
+    .stages = SHASH_INITIALIZER(&daemon_registry.stages),
+    .arena = SYSD_ARENA_INITIALIZER,
+};
+
+void
+sysd_daemon_registry_init(sysd_daemon_registry_t *reg)
+{
+    reg->daemons = NULL;
+    reg->n_daemons = 0;
+    reg->allocated = 0;
+    reg->n_hw_daemons = 0;
+    hmap_init(&reg->by_name);
+    shash_init(&reg->stages);
+    reg->order = NULL;
+    sysd_arena_init(&reg->arena, 0);
+
+} /* sysd_daemon_registry_init */
+
+void
+sysd_daemon_registry_destroy(sysd_daemon_registry_t *reg)
+{
+    daemon_info_t       *daemon;
+
+    SYSD_DAEMON_FOR_EACH (daemon, reg) {
+        free(daemon->depends_on);
+        free(daemon->deps);
+    }
+
+    /* The stages and the dependency names live in the arena. */
+    shash_destroy(&reg->stages);
+    sysd_arena_destroy(&reg->arena);
+
+    hmap_destroy(&reg->by_name);
+    free(reg->daemons);
+    free(reg->order);
+    reg->daemons = NULL;
+    reg->order = NULL;
+    reg->n_daemons = 0;
+    reg->allocated = 0;
+    reg->n_hw_daemons = 0;
+
+} /* sysd_daemon_registry_destroy */
+
+/* Makes room for at least 'n' daemons. Moving the array invalidates the
+ * hmap nodes, so the index is rebuilt after every reallocation. */
+void
+sysd_daemon_registry_reserve(sysd_daemon_registry_t *reg, size_t n)
+{
+    daemon_info_t   *daemon;
+
+    if (n <= reg->allocated) {
+        return;
+    }
+
+    reg->allocated = MAX(n, 2 * reg->allocated);
+    reg->daemons = xrealloc(reg->daemons,
+                            reg->allocated * sizeof *reg->daemons);
+
+    hmap_clear(&reg->by_name);
+    hmap_reserve(&reg->by_name, reg->allocated);
+    SYSD_DAEMON_FOR_EACH (daemon, reg) {
+        hmap_insert(&reg->by_name, &daemon->hmap_node,
+                    hash_string(daemon->name, 0));
+    }
+
+} /* sysd_daemon_registry_reserve */
+
+daemon_info_t *
+sysd_daemon_registry_find(const sysd_daemon_registry_t *reg, const char *name)
+{
+    daemon_info_t   *daemon;
+
+    HMAP_FOR_EACH_WITH_HASH (daemon, hmap_node, hash_string(name, 0),
+                             &reg->by_name) {
+        if (!strcmp(daemon->name, name)) {
+            return daemon;
+        }
+    }
+
+    return NULL;
+
+} /* sysd_daemon_registry_find */
+
+/* Adds a zero initialized entry for 'name' and returns it. If the daemon
+ * is already registered the existing entry is returned. */
+daemon_info_t *
+sysd_daemon_registry_add(sysd_daemon_registry_t *reg, const char *name)
+{
+    daemon_info_t   *daemon;
+
+    if (strlen(name) >= MAX_DAEMON_NAME_LEN) {
+        VLOG_WARN("Daemon name '%s' is longer than %d characters, truncating",
+                  name, MAX_DAEMON_NAME_LEN - 1);
+    }
+
+    daemon = sysd_daemon_registry_find(reg, name);
+    if (daemon != NULL) {
+        VLOG_WARN("Daemon '%s' listed more than once in the manifest", name);
+        return daemon;
+    }
+
+    sysd_daemon_registry_reserve(reg, reg->n_daemons + 1);
+
+    daemon = &reg->daemons[reg->n_daemons++];
+    memset(daemon, 0, sizeof *daemon);
+    ovs_strlcpy(daemon->name, name, sizeof daemon->name);
+    hmap_insert(&reg->by_name, &daemon->hmap_node,
+                hash_string(daemon->name, 0));
+
+    return daemon;
+
+} /* sysd_daemon_registry_add */
+
+void
+sysd_daemon_registry_count_hw(sysd_daemon_registry_t *reg)
+{
+    daemon_info_t   *daemon;
+
+    reg->n_hw_daemons = 0;
+    SYSD_DAEMON_FOR_EACH (daemon, reg) {
+        if (daemon->is_hw_handler) {
+            reg->n_hw_daemons++;
+        }
+    }
+
+} /* sysd_daemon_registry_count_hw */
+
+/* Assigns 'daemon' to the readiness stage 'stage_name', creating the
+ * stage on first use. */
+void
+sysd_daemon_set_stage(sysd_daemon_registry_t *reg, daemon_info_t *daemon,
+                      const char *stage_name)
+{
+    sysd_daemon_stage_t *stage;
+
+    if (daemon->stage != NULL) {
+        daemon->stage->n_daemons--;
+    }
+
+    stage = shash_find_data(&reg->stages, stage_name);
+    if (stage == NULL) {
+        stage = sysd_arena_alloc(&reg->arena, sizeof *stage);
+        stage->name = sysd_arena_strdup(&reg->arena, stage_name);
+        shash_add(&reg->stages, stage_name, stage);
+    }
+
+    stage->n_daemons++;
+    daemon->stage = stage;
+
+} /* sysd_daemon_set_stage */
+
+/* Records that 'daemon' depends on the daemon called 'name'. Names are
+ * resolved by sysd_daemon_registry_build_graph() once the whole manifest
+ * has been read, since dependencies may be listed before they are
+ * defined. */
+void
+sysd_daemon_add_dependency(sysd_daemon_registry_t *reg,
+                           daemon_info_t *daemon, const char *name)
+{
+    daemon->depends_on = xrealloc(daemon->depends_on,
+                                  (daemon->n_depends_on + 1)
+                                  * sizeof *daemon->depends_on);
+    daemon->depends_on[daemon->n_depends_on++] =
+        sysd_arena_strdup(&reg->arena, name);
+
+} /* sysd_daemon_add_dependency */
+
+enum sysd_visit_state {
+    SYSD_UNVISITED,
+    SYSD_VISITING,
+    SYSD_VISITED
+};
+
+static int
+sysd_daemon_visit(sysd_daemon_registry_t *reg, size_t idx,
+                  enum sysd_visit_state *state, size_t *n_order)
+{
+    daemon_info_t   *daemon = &reg->daemons[idx];
+    size_t          i;
+
+    if (state[idx] == SYSD_VISITED) {
+        return 0;
+    } else if (state[idx] == SYSD_VISITING) {
+        VLOG_ERR("Dependency cycle in image.manifest through daemon '%s'",
+                 daemon->name);
+        return -1;
+    }
+
+    state[idx] = SYSD_VISITING;
+    for (i = 0; i < daemon->n_deps; i++) {
+        if (sysd_daemon_visit(reg, daemon->deps[i], state, n_order)) {
+            return -1;
+        }
+    }
+    state[idx] = SYSD_VISITED;
+
+    reg->order[(*n_order)++] = idx;
+
+    return 0;
+
+} /* sysd_daemon_visit */
+
+/* Resolves every daemon's depends_on list and computes an evaluation
+ * order in which each daemon comes after all of its dependencies.
+ * Unknown dependencies are logged and ignored. Returns -1 if the
+ * dependencies contain a cycle, 0 otherwise. */
+int
+sysd_daemon_registry_build_graph(sysd_daemon_registry_t *reg)
+{
+    enum sysd_visit_state   *state;
+    daemon_info_t           *daemon;
+    daemon_info_t           *dep;
+    size_t                  n_order = 0;
+    size_t                  i;
+    int                     rc = 0;
+
+    SYSD_DAEMON_FOR_EACH (daemon, reg) {
+        free(daemon->deps);
+        daemon->deps = xmalloc(daemon->n_depends_on * sizeof *daemon->deps);
+        daemon->n_deps = 0;
+
+        for (i = 0; i < daemon->n_depends_on; i++) {
+            dep = sysd_daemon_registry_find(reg, daemon->depends_on[i]);
+            if (dep == NULL) {
+                VLOG_WARN("Daemon '%s' depends on '%s', which is not in "
+                          "image.manifest; ignoring", daemon->name,
+                          daemon->depends_on[i]);
+                continue;
+            }
+            daemon->deps[daemon->n_deps++] = dep - reg->daemons;
+        }
+    }
+
+    free(reg->order);
+    reg->order = xmalloc(reg->n_daemons * sizeof *reg->order);
+    state = xcalloc(reg->n_daemons, sizeof *state);
+
+    for (i = 0; i < reg->n_daemons; i++) {
+        rc = sysd_daemon_visit(reg, i, state, &n_order);
+        if (rc) {
+            break;
+        }
+    }
+
+    free(state);
+
+    return rc;
+
+} /* sysd_daemon_registry_build_graph */
+
+/* Points every registered daemon at its Daemon table row, or NULL if the
+ * row does not exist (yet). Must be called again after ovsdb_idl_run()
+ * since rows may have been deleted. */
+void
+sysd_daemon_registry_bind_rows(sysd_daemon_registry_t *reg,
+                               const struct ovsdb_idl *idl)
+{
+    const struct ovsrec_daemon  *row;
+    daemon_info_t               *daemon;
+
+    SYSD_DAEMON_FOR_EACH (daemon, reg) {
+        daemon->row = NULL;
+    }
+
+    OVSREC_DAEMON_FOR_EACH (row, idl) {
+        daemon = sysd_daemon_registry_find(reg, row->name);
+        if (daemon != NULL) {
+            daemon->row = row;
+        }
+    }
+
+} /* sysd_daemon_registry_bind_rows */
+
+/* Recomputes the 'ready' flag of every daemon and the ready count of every
+ * stage from the currently bound Daemon rows. */
+void
+sysd_daemon_registry_eval_ready(sysd_daemon_registry_t *reg)
+{
+    struct shash_node   *node;
+    daemon_info_t       *daemon;
+    size_t              i, j;
+
+    if (reg->order == NULL) {
+        return;
+    }
+
+    SHASH_FOR_EACH (node, &reg->stages) {
+        sysd_daemon_stage_t *stage = node->data;
+
+        stage->n_ready = 0;
+    }
+
+    /* Dependencies come first in 'order', so their flags are current. */
+    for (i = 0; i < reg->n_daemons; i++) {
+        daemon = &reg->daemons[reg->order[i]];
+
+        daemon->ready = !daemon->is_hw_handler
+                        || (daemon->row != NULL && daemon->row->cur_hw > 0);
+
+        for (j = 0; j < daemon->n_deps && daemon->ready; j++) {
+            daemon->ready = reg->daemons[daemon->deps[j]].ready;
+        }
+
+        if (daemon->ready && daemon->stage != NULL) {
+            daemon->stage->n_ready++;
+        }
+    }
+
+} /* sysd_daemon_registry_eval_ready */
+
+/* Adds the number of daemons and the bytes the registry holds for them
+ * to 'usage', for memory/show. */
+void
+sysd_daemon_registry_get_memory_usage(const sysd_daemon_registry_t *reg,
+                                      struct simap *usage)
+{
+    const struct shash_node *node;
+    const daemon_info_t     *daemon;
+    size_t                  bytes;
+
+    bytes = reg->allocated * sizeof *reg->daemons
+            + (reg->by_name.mask + 1) * sizeof *reg->by_name.buckets
+            + reg->arena.allocated;
+    if (reg->order != NULL) {
+        bytes += reg->n_daemons * sizeof *reg->order;
+    }
+
+    SYSD_DAEMON_FOR_EACH (daemon, reg) {
+        bytes += daemon->n_depends_on * sizeof *daemon->depends_on
+                 + daemon->n_deps * sizeof *daemon->deps;
+    }
+
+    /* The shash keeps its own copy of each stage name. */
+    SHASH_FOR_EACH (node, &reg->stages) {
+        bytes += sizeof *node + strlen(node->name) + 1;
+    }
+
+    simap_increase(usage, "daemons", reg->n_daemons);
+    simap_increase(usage, "daemon_bytes", bytes);
+
+} /* sysd_daemon_registry_get_memory_usage */
+/** @} end of group sysd */
@@ -24,8 +24,11 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 #include <openvswitch/vlog.h>
+#include <coverage.h>
 #include <util.h>
 
 #include <ops-utils.h>
@@ -33,6 +36,7 @@
 #include <i2c.h>
 
 #include "sysd_util.h"
+#include "sysd_arena.h"
 #include "sysd_fru.h"
 #include "sysd_cfg_yaml.h"
 #include "sysd.h"
@@ -41,13 +45,18 @@
 
 VLOG_DEFINE_THIS_MODULE(fru);
 
+COVERAGE_DEFINE(sysd_fru_read);
+
 extern bool fru_yaml;
 
+#define SYSD_MAC_SALT_LEN   8
+
 /** @ingroup sysd
  * @{ */
 
 bool
-sysd_process_eeprom(unsigned char *buf, fru_eeprom_t *fru_eeprom, int len)
+sysd_process_eeprom(unsigned char *buf, fru_eeprom_t *fru_eeprom, int len,
+                    struct sysd_arena *arena)
 {
     int                 idx = 0;
     int                 skip;
@@ -72,21 +81,18 @@ sysd_process_eeprom(unsigned char *buf, fru_eeprom_t *fru_eeprom, int len)
 
         switch(fru_tlv->code) {
             case FRU_PRODUCT_NAME_TYPE:
-                SYSD_MALLOC(fru_eeprom->product_name, tlv_len + 1);
-                strncpy(fru_eeprom->product_name, tlv_value, tlv_len);
-                fru_eeprom->product_name[tlv_len] = '\0';
+                fru_eeprom->product_name =
+                    sysd_arena_memdup0(arena, tlv_value, tlv_len);
                 break;
 
             case FRU_PART_NUMBER_TYPE:
-                SYSD_MALLOC(fru_eeprom->part_number, tlv_len + 1);
-                strncpy(fru_eeprom->part_number, tlv_value, tlv_len);
-                fru_eeprom->part_number[tlv_len] = '\0';
+                fru_eeprom->part_number =
+                    sysd_arena_memdup0(arena, tlv_value, tlv_len);
                 break;
 
             case FRU_SERIAL_NUMBER_TYPE:
-                SYSD_MALLOC(fru_eeprom->serial_number, tlv_len + 1);
-                strncpy(fru_eeprom->serial_number, tlv_value, tlv_len);
-                fru_eeprom->serial_number[tlv_len] = '\0';
+                fru_eeprom->serial_number =
+                    sysd_arena_memdup0(arena, tlv_value, tlv_len);
                 break;
 
             case FRU_NUM_MAC_TYPE:
@@ -109,27 +115,23 @@ sysd_process_eeprom(unsigned char *buf, fru_eeprom_t *fru_eeprom, int len)
                 break;
 
             case FRU_LABEL_REVISION_TYPE:
-                SYSD_MALLOC(fru_eeprom->label_revision, tlv_len + 1);
-                strncpy(fru_eeprom->label_revision, tlv_value, tlv_len);
-                fru_eeprom->label_revision[tlv_len] = '\0';
+                fru_eeprom->label_revision =
+                    sysd_arena_memdup0(arena, tlv_value, tlv_len);
                 break;
 
             case FRU_PLATFORM_NAME_TYPE:
-                SYSD_MALLOC(fru_eeprom->platform_name, tlv_len + 1);
-                strncpy(fru_eeprom->platform_name, tlv_value, tlv_len);
-                fru_eeprom->platform_name[tlv_len] = '\0';
+                fru_eeprom->platform_name =
+                    sysd_arena_memdup0(arena, tlv_value, tlv_len);
                 break;
 
             case FRU_ONIE_VERSION_TYPE:
-                SYSD_MALLOC(fru_eeprom->onie_version, tlv_len + 1);
-                strncpy(fru_eeprom->onie_version, tlv_value, tlv_len);
-                fru_eeprom->onie_version[tlv_len] = '\0';
+                fru_eeprom->onie_version =
+                    sysd_arena_memdup0(arena, tlv_value, tlv_len);
                 break;
 
             case FRU_MANUFACTURER_TYPE:
-                SYSD_MALLOC(fru_eeprom->manufacturer, tlv_len + 1);
-                strncpy(fru_eeprom->manufacturer, tlv_value, tlv_len);
-                fru_eeprom->manufacturer[tlv_len] = '\0';
+                fru_eeprom->manufacturer =
+                    sysd_arena_memdup0(arena, tlv_value, tlv_len);
                 break;
 
             case FRU_COUNTRY_CODE_TYPE:
@@ -138,21 +140,18 @@ sysd_process_eeprom(unsigned char *buf, fru_eeprom_t *fru_eeprom, int len)
                 break;
 
             case FRU_VENDOR_TYPE:
-                SYSD_MALLOC(fru_eeprom->vendor, tlv_len + 1);
-                strncpy(fru_eeprom->vendor, tlv_value, tlv_len);
-                fru_eeprom->vendor[tlv_len] = '\0';
+                fru_eeprom->vendor =
+                    sysd_arena_memdup0(arena, tlv_value, tlv_len);
                 break;
 
             case FRU_DIAG_VERSION_TYPE:
-                SYSD_MALLOC(fru_eeprom->diag_version, tlv_len + 1);
-                strncpy(fru_eeprom->diag_version, tlv_value, tlv_len);
-                fru_eeprom->diag_version[tlv_len] = '\0';
+                fru_eeprom->diag_version =
+                    sysd_arena_memdup0(arena, tlv_value, tlv_len);
                 break;
 
             case FRU_SERVICE_TAG_TYPE:
-                SYSD_MALLOC(fru_eeprom->service_tag, tlv_len + 1);
-                strncpy(fru_eeprom->service_tag, tlv_value, tlv_len);
-                fru_eeprom->service_tag[tlv_len] = '\0';
+                fru_eeprom->service_tag =
+                    sysd_arena_memdup0(arena, tlv_value, tlv_len);
                 break;
 
             case FRU_VENDOR_EXTENSION_TYPE:
@@ -191,8 +190,209 @@ sysd_process_eeprom(unsigned char *buf, fru_eeprom_t *fru_eeprom, int len)
     return (true);
 } /* sysd_process_eeprom() */
 
+#ifdef RANDOM_BASE_MAC
+static void
+sysd_fru_randomize_base_mac(fru_eeprom_t *fru_eeprom)
+{
+    struct timespec tp;
+    unsigned int nsec_low;
+
+    /*
+     * Generate a random mac address everytime for vsi
+     * To have some sane values, use rand to generate
+     * only the last 24 bits
+     */
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    nsec_low = (unsigned int) (tp.tv_nsec & 0x00000000FFFFFFFF);
+    srand(nsec_low);
+    fru_eeprom->base_mac_address[3] = rand() & 0xff;
+    fru_eeprom->base_mac_address[4] = rand() & 0xff;
+    fru_eeprom->base_mac_address[5] = rand() & 0xff;
+
+} /* sysd_fru_randomize_base_mac */
+#else
+/*
+ * Returns the inputs the base MAC is derived from: the OUI from fru.yaml,
+ * the size of the MAC pool, the serial number and the platform name.
+ * They are persisted with the MAC so that a change to any of them gets
+ * a freshly derived MAC. Caller must free it.
+ */
+static char *
+sysd_fru_mac_inputs(const fru_eeprom_t *fru_eeprom)
+{
+    return xasprintf("%02x:%02x:%02x/%d/%s/%s",
+                     fru_eeprom->base_mac_address[0],
+                     fru_eeprom->base_mac_address[1],
+                     fru_eeprom->base_mac_address[2],
+                     fru_eeprom->num_macs,
+                     fru_eeprom->serial_number ? : "",
+                     fru_eeprom->platform_name ? : "");
+
+} /* sysd_fru_mac_inputs */
+
+/*
+ * Parses a persisted base MAC entry, "<mac> <inputs>". The MAC is only
+ * reused if it was derived from the same 'inputs' as the current ones.
+ */
+static bool
+sysd_fru_parse_mac(const char *str, const char *inputs, uint8_t *mac)
+{
+    uint8_t     tmp[FRU_BASE_MAC_ADDRESS_LEN];
+    int         len = 0;
+
+    if (str == NULL ||
+        sscanf(str, "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx%n",
+               &tmp[0], &tmp[1], &tmp[2], &tmp[3], &tmp[4], &tmp[5],
+               &len) != 6) {
+        return false;
+    }
+
+    if (str[len] != ' ' || strcmp(&str[len + 1], inputs)) {
+        VLOG_INFO("Base MAC inputs changed, deriving a new base MAC");
+        return false;
+    }
+
+    /* Never hand out a multicast base MAC. */
+    if (tmp[0] & 0x01) {
+        return false;
+    }
+
+    memcpy(mac, tmp, FRU_BASE_MAC_ADDRESS_LEN);
+    return true;
+
+} /* sysd_fru_parse_mac */
+
+/*
+ * Returns the per-switch salt used to derive the base MAC, creating
+ * and persisting a new one on first use. The salt keeps VMs that share
+ * the same fru.yaml from deriving the same MAC. Caller must free it.
+ */
+static char *
+sysd_fru_get_mac_salt(void)
+{
+    unsigned char   rnd[SYSD_MAC_SALT_LEN];
+    char            *salt;
+    struct timespec tp;
+    FILE            *fp;
+    int             i;
+
+    salt = sysd_state_file_read(SYSD_MAC_SALT_FILE_PATH);
+    if (salt != NULL && salt[0] != '\0') {
+        return salt;
+    }
+    free(salt);
+
+    fp = fopen("/dev/urandom", "r");
+    if (fp == NULL || fread(rnd, 1, sizeof(rnd), fp) != sizeof(rnd)) {
+        VLOG_WARN("Unable to read /dev/urandom, seeding MAC salt from clock");
+        clock_gettime(CLOCK_REALTIME, &tp);
+        srand((unsigned int) (tp.tv_nsec ^ tp.tv_sec ^ getpid()));
+        for (i = 0; i < sizeof(rnd); i++) {
+            rnd[i] = rand() & 0xff;
+        }
+    }
+    if (fp != NULL) {
+        fclose(fp);
+    }
+
+    salt = xmalloc(2 * sizeof(rnd) + 1);
+    for (i = 0; i < sizeof(rnd); i++) {
+        snprintf(&salt[2 * i], 3, "%02x", rnd[i]);
+    }
+
+    if (sysd_state_file_write(SYSD_MAC_SALT_FILE_PATH, salt)) {
+        VLOG_WARN("Unable to persist MAC salt, base MAC may change on reboot");
+    }
+
+    return salt;
+
+} /* sysd_fru_get_mac_salt */
+
+/*
+ * Derives the NIC specific part of the base MAC from the serial number,
+ * the platform name and the persisted salt. The OUI from fru.yaml is
+ * kept as is.
+ */
+static void
+sysd_fru_derive_base_mac(fru_eeprom_t *fru_eeprom)
+{
+    char            *salt;
+    char            *seed;
+    unsigned int    nic;
+
+    salt = sysd_fru_get_mac_salt();
+    seed = xasprintf("%s/%s/%s",
+                     fru_eeprom->serial_number ? : "",
+                     fru_eeprom->platform_name ? : "",
+                     salt);
+
+    nic = calc_crc((unsigned char *) seed, strlen(seed)) & 0xffffff;
+
+    /* Keep the whole MAC pool inside the OUI. */
+    if (nic + fru_eeprom->num_macs > 0xffffff) {
+        nic -= fru_eeprom->num_macs;
+    }
+
+    fru_eeprom->base_mac_address[3] = (nic >> 16) & 0xff;
+    fru_eeprom->base_mac_address[4] = (nic >> 8) & 0xff;
+    fru_eeprom->base_mac_address[5] = nic & 0xff;
+
+    free(seed);
+    free(salt);
+
+} /* sysd_fru_derive_base_mac */
+#endif /* RANDOM_BASE_MAC */
+
+/*
+ * fru.yaml platforms (including simulation) do not have a unique base
+ * MAC of their own. Reuse the persisted base MAC if it was derived from
+ * the current fru.yaml, otherwise derive a stable one and persist it,
+ * so that restarting sysd does not change the system MAC under the
+ * neighbors' feet.
+ */
+static void
+sysd_fru_set_yaml_base_mac(fru_eeprom_t *fru_eeprom)
+{
+    char        mac_str[32];
+#ifdef RANDOM_BASE_MAC
+    sysd_fru_randomize_base_mac(fru_eeprom);
+#else
+    char        *persisted;
+    char        *inputs;
+    char        *entry;
+
+    inputs = sysd_fru_mac_inputs(fru_eeprom);
+    persisted = sysd_state_file_read(SYSD_BASE_MAC_FILE_PATH);
+    if (sysd_fru_parse_mac(persisted, inputs, fru_eeprom->base_mac_address)) {
+        VLOG_INFO("Using persisted base MAC %.17s", persisted);
+        free(persisted);
+        free(inputs);
+        return;
+    }
+    free(persisted);
+
+    sysd_fru_derive_base_mac(fru_eeprom);
+#endif
+
+    snprintf(mac_str, sizeof(mac_str), "%02x:%02x:%02x:%02x:%02x:%02x",
+             fru_eeprom->base_mac_address[0], fru_eeprom->base_mac_address[1],
+             fru_eeprom->base_mac_address[2], fru_eeprom->base_mac_address[3],
+             fru_eeprom->base_mac_address[4], fru_eeprom->base_mac_address[5]);
+    VLOG_INFO("Using base MAC %s", mac_str);
+
+#ifndef RANDOM_BASE_MAC
+    entry = xasprintf("%s %s", mac_str, inputs);
+    if (sysd_state_file_write(SYSD_BASE_MAC_FILE_PATH, entry)) {
+        VLOG_WARN("Unable to persist base MAC %s", mac_str);
+    }
+    free(entry);
+    free(inputs);
+#endif
+
+} /* sysd_fru_set_yaml_base_mac */
+
 int
-sysd_read_fru_eeprom(fru_eeprom_t *fru_eeprom)
+sysd_read_fru_eeprom(fru_eeprom_t *fru_eeprom, struct sysd_arena *arena)
 {
     bool            rc;
     unsigned char   *buf;
@@ -200,13 +400,16 @@ sysd_read_fru_eeprom(fru_eeprom_t *fru_eeprom)
     uint16_t        total_len;
     fru_header_t    header;
 
+    COVERAGE_INC(sysd_fru_read);
+
     if (fru_yaml) {
         /* Populate fru from yaml file */
-        rc = sysd_cfg_yaml_get_fru_info(fru_eeprom);
+        rc = sysd_cfg_yaml_get_fru_info(fru_eeprom, arena);
         if (0 > rc) {
             VLOG_ERR("Error getting yaml fru info. rc = %d.", rc);
             return -1;
         }
+        sysd_fru_set_yaml_base_mac(fru_eeprom);
         VLOG_INFO("Retrieved fru info from fru.yaml");
         return 0;
     }
@@ -247,7 +450,7 @@ sysd_read_fru_eeprom(fru_eeprom_t *fru_eeprom)
     }
 
     /* Populate EEPROM struct */
-    rc = sysd_process_eeprom(buf, fru_eeprom, (int)total_len);
+    rc = sysd_process_eeprom(buf, fru_eeprom, (int)total_len, arena);
     if (!rc) {
         VLOG_ERR("Error processing FRU EEPROM info");
         free(buf);
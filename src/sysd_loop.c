@@ -0,0 +1,278 @@
+/************************************************************************//**
+ * (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *    License for the specific language governing permissions and limitations
+ *    under the License.
+ *
+ ***************************************************************************/
+/* @ingroup sysd
+ *
+ * @file
+ * Source for sysd main loop profiling.
+ *
+ * Each pass of the main loop records what woke it and how long it spent
+ * in every handler before going back to poll_block(). The busy time of
+ * the last SYSD_LOOP_HISTORY_LEN passes is kept for a rolling latency
+ * histogram, next to a histogram over the whole life of the process.
+ *
+ * The poll loop does not say which fd woke it, so the wake reason is
+ * inferred from what the handlers found to do: a changed IDL seqno is a
+ * database wakeup, an expired watchdog deadline is a timer wakeup and a
+ * pass that never blocked is a spin.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <util.h>
+#include <dynamic-string.h>
+#include <timeval.h>
+
+#include "sysd_loop.h"
+
+/** @ingroup sysd
+ * @{ */
+
+struct sysd_loop_sample {
+    uint32_t        busy_usec;
+    uint8_t         reason;
+};
+
+struct sysd_loop_stats {
+    /* Current iteration. */
+    long long int   iter_start;     /* time_usec() when it woke up. */
+    long long int   mark;           /* End of the previous phase. */
+    enum sysd_loop_wake reason;
+    enum sysd_loop_wake next_reason;
+
+    long long int   idle_start;     /* time_usec() entering poll_block(). */
+    long long int   idle_usec;
+
+    /* Totals since start or the last clear. */
+    unsigned long long n_iterations;
+    unsigned long long n_wakes[SYSD_WAKE_N_REASONS];
+    long long int   phase_usec[SYSD_LOOP_N_PHASES];
+    long long int   phase_max_usec[SYSD_LOOP_N_PHASES];
+    unsigned long long histogram[SYSD_LOOP_N_BUCKETS];
+    long long int   max_busy_usec;
+
+    /* Rolling window. */
+    struct sysd_loop_sample samples[SYSD_LOOP_HISTORY_LEN];
+    size_t          n_samples;
+    size_t          next_sample;
+};
+
+static struct sysd_loop_stats stats;
+
+static const char *sysd_loop_phase_names[SYSD_LOOP_N_PHASES] = {
+    "sysd_run",
+    "unixctl_server_run",
+    "wait",
+};
+
+static const char *sysd_loop_wake_names[SYSD_WAKE_N_REASONS] = {
+    "other",
+    "timer",
+    "db",
+    "spin",
+};
+
+static int
+sysd_loop_bucket(long long int usec)
+{
+    int bucket = 0;
+
+    while (usec > 1 && bucket < SYSD_LOOP_N_BUCKETS - 1) {
+        usec >>= 1;
+        bucket++;
+    }
+    return bucket;
+
+} /* sysd_loop_bucket */
+
+/* Called when poll_block() returns, or at the top of a pass that did not
+ * block. */
+void
+sysd_loop_begin(void)
+{
+    long long int now = time_usec();
+
+    if (stats.idle_start) {
+        stats.idle_usec += now - stats.idle_start;
+        stats.idle_start = 0;
+    }
+
+    stats.iter_start = stats.mark = now;
+    stats.reason = stats.next_reason;
+    stats.next_reason = SYSD_WAKE_OTHER;
+
+} /* sysd_loop_begin */
+
+/* Charges the time since the previous phase ended to 'phase'. */
+void
+sysd_loop_phase_done(enum sysd_loop_phase phase)
+{
+    long long int now = time_usec();
+    long long int usec = now - stats.mark;
+
+    stats.phase_usec[phase] += usec;
+    stats.phase_max_usec[phase] = MAX(stats.phase_max_usec[phase], usec);
+    stats.mark = now;
+
+} /* sysd_loop_phase_done */
+
+/* Records that the current pass found work of kind 'reason'. The most
+ * specific reason noted during a pass wins. */
+void
+sysd_loop_note_wake(enum sysd_loop_wake reason)
+{
+    stats.reason = MAX(stats.reason, reason);
+
+} /* sysd_loop_note_wake */
+
+/* Closes the current pass. 'spin' is true if the main loop goes round
+ * again without blocking. */
+void
+sysd_loop_end(bool spin)
+{
+    struct sysd_loop_sample *sample;
+    long long int now = time_usec();
+    long long int busy = now - stats.iter_start;
+
+    stats.n_iterations++;
+    stats.n_wakes[stats.reason]++;
+    stats.histogram[sysd_loop_bucket(busy)]++;
+    stats.max_busy_usec = MAX(stats.max_busy_usec, busy);
+
+    sample = &stats.samples[stats.next_sample];
+    sample->busy_usec = MIN(busy, UINT32_MAX);
+    sample->reason = stats.reason;
+    stats.next_sample = (stats.next_sample + 1) % SYSD_LOOP_HISTORY_LEN;
+    if (stats.n_samples < SYSD_LOOP_HISTORY_LEN) {
+        stats.n_samples++;
+    }
+
+    if (spin) {
+        stats.next_reason = SYSD_WAKE_SPIN;
+    } else {
+        stats.idle_start = now;
+    }
+
+} /* sysd_loop_end */
+
+void
+sysd_loop_clear(void)
+{
+    long long int idle_start = stats.idle_start;
+    long long int iter_start = stats.iter_start;
+    long long int mark = stats.mark;
+    enum sysd_loop_wake reason = stats.reason;
+    enum sysd_loop_wake next_reason = stats.next_reason;
+
+    memset(&stats, 0, sizeof stats);
+
+    /* Called from inside a pass, so keep that pass going. */
+    stats.idle_start = idle_start;
+    stats.iter_start = iter_start;
+    stats.mark = mark;
+    stats.reason = reason;
+    stats.next_reason = next_reason;
+
+} /* sysd_loop_clear */
+
+static int
+sysd_loop_usec_cmp(const void *a_, const void *b_)
+{
+    const uint32_t *a = a_;
+    const uint32_t *b = b_;
+
+    return *a < *b ? -1 : *a > *b;
+
+} /* sysd_loop_usec_cmp */
+
+static void
+sysd_loop_put_bucket(struct ds *ds, int bucket)
+{
+    if (bucket == 0) {
+        ds_put_format(ds, "  %20s", "< 2 us");
+    } else if (bucket == SYSD_LOOP_N_BUCKETS - 1) {
+        ds_put_format(ds, "  %11s%6lld us", ">= ", 1LL << bucket);
+    } else {
+        ds_put_format(ds, "  %8lld - %6lld us", 1LL << bucket,
+                      (1LL << (bucket + 1)) - 1);
+    }
+
+} /* sysd_loop_put_bucket */
+
+void
+sysd_loop_dump(struct ds *ds)
+{
+    unsigned long long recent[SYSD_LOOP_N_BUCKETS];
+    unsigned long long recent_wakes[SYSD_WAKE_N_REASONS];
+    uint32_t    *sorted;
+    size_t      i;
+    int         b;
+
+    ds_put_format(ds, "Iterations: %llu, idle %lld ms\n\n",
+                  stats.n_iterations, stats.idle_usec / 1000);
+
+    ds_put_format(ds, "%-20s %12s %12s %12s\n",
+                  "Handler", "Total (us)", "Avg (us)", "Max (us)");
+    for (i = 0; i < SYSD_LOOP_N_PHASES; i++) {
+        ds_put_format(ds, "%-20s %12lld %12lld %12lld\n",
+                      sysd_loop_phase_names[i], stats.phase_usec[i],
+                      stats.n_iterations
+                      ? stats.phase_usec[i] / (long long) stats.n_iterations
+                      : 0,
+                      stats.phase_max_usec[i]);
+    }
+
+    memset(recent, 0, sizeof recent);
+    memset(recent_wakes, 0, sizeof recent_wakes);
+    sorted = xmalloc(MAX(stats.n_samples, 1) * sizeof *sorted);
+    for (i = 0; i < stats.n_samples; i++) {
+        sorted[i] = stats.samples[i].busy_usec;
+        recent[sysd_loop_bucket(sorted[i])]++;
+        recent_wakes[stats.samples[i].reason]++;
+    }
+
+    ds_put_format(ds, "\n%-20s %12s %12s\n", "Wake reason", "Total",
+                  "Recent");
+    for (i = 0; i < SYSD_WAKE_N_REASONS; i++) {
+        ds_put_format(ds, "%-20s %12llu %12llu\n", sysd_loop_wake_names[i],
+                      stats.n_wakes[i], recent_wakes[i]);
+    }
+
+    ds_put_format(ds, "\nBusy time per iteration (last %"PRIuSIZE
+                  " iterations",  stats.n_samples);
+    if (stats.n_samples) {
+        qsort(sorted, stats.n_samples, sizeof *sorted, sysd_loop_usec_cmp);
+        ds_put_format(ds, ": p50 %"PRIu32" us, p99 %"PRIu32" us",
+                      sorted[DIV_ROUND_UP(stats.n_samples * 50, 100) - 1],
+                      sorted[DIV_ROUND_UP(stats.n_samples * 99, 100) - 1]);
+    }
+    ds_put_format(ds, "; max ever %lld us)\n", stats.max_busy_usec);
+    free(sorted);
+
+    ds_put_format(ds, "  %20s %12s %12s\n", "Latency", "Total", "Recent");
+    for (b = 0; b < SYSD_LOOP_N_BUCKETS; b++) {
+        if (!stats.histogram[b]) {
+            continue;
+        }
+        sysd_loop_put_bucket(ds, b);
+        ds_put_format(ds, " %12llu %12llu\n", stats.histogram[b], recent[b]);
+    }
+
+} /* sysd_loop_dump */
+/** @} end of group sysd */
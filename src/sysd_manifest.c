@@ -0,0 +1,762 @@
+/************************************************************************//**
+ * (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *    License for the specific language governing permissions and limitations
+ *    under the License.
+ *
+ ***************************************************************************/
+/* @ingroup sysd
+ *
+ * @file
+ * Source for the sysd streaming image.manifest reader.
+ *
+ * The manifest is read token by token straight from the file. No JSON
+ * tree is built: the sections sysd knows about ("daemons", "readiness"
+ * and "mgmt_intf") are handed to the daemon registry as they are read and
+ * anything else is skipped. The schema is validated in the same pass and
+ * every error is reported with its line, column and the path of the
+ * offending member, e.g.
+ *
+ *   image.manifest:12:30: 'ready_timeout' must be a number of seconds
+ *   (at daemons.ops-fand.ready_timeout)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#include <util.h>
+#include <dynamic-string.h>
+#include <openvswitch/vlog.h>
+
+#include "sysd_util.h"
+#include "sysd_manifest.h"
+#include "sysd_arena.h"
+
+VLOG_DEFINE_THIS_MODULE(sysd_manifest);
+
+/** @ingroup sysd
+ * @{ */
+
+enum sysd_manifest_token {
+    SYSD_MT_EOF,
+    SYSD_MT_ERROR,
+    SYSD_MT_BEGIN_OBJECT,
+    SYSD_MT_END_OBJECT,
+    SYSD_MT_BEGIN_ARRAY,
+    SYSD_MT_END_ARRAY,
+    SYSD_MT_COLON,
+    SYSD_MT_COMMA,
+    SYSD_MT_STRING,
+    SYSD_MT_INTEGER,
+    SYSD_MT_REAL,
+    SYSD_MT_TRUE,
+    SYSD_MT_FALSE,
+    SYSD_MT_NULL
+};
+
+struct sysd_manifest_reader {
+    FILE            *stream;
+    const char      *file_name;
+
+    int             c;          /* Lookahead character, or EOF. */
+    int             line;       /* Position of 'c'. */
+    int             column;
+
+    /* Current token. */
+    enum sysd_manifest_token token;
+    int             tok_line;
+    int             tok_column;
+    struct ds       string;     /* SYSD_MT_STRING. */
+    long long int   integer;    /* SYSD_MT_INTEGER. */
+    double          real;       /* SYSD_MT_REAL. */
+
+    struct ds       path;       /* Member path, for error messages. */
+    bool            error;      /* An error has been reported. */
+};
+
+typedef bool sysd_manifest_member_cb(struct sysd_manifest_reader *,
+                                     const char *name, void *aux);
+typedef bool sysd_manifest_element_cb(struct sysd_manifest_reader *,
+                                      size_t idx, void *aux);
+
+static void sysd_manifest_error(struct sysd_manifest_reader *,
+                                const char *format, ...)
+    OVS_PRINTF_FORMAT(2, 3);
+
+/* Reports the first error found in the manifest, at the position of the
+ * current token. Later errors are usually a consequence of the first one
+ * and are dropped. */
+static void
+sysd_manifest_error(struct sysd_manifest_reader *r, const char *format, ...)
+{
+    va_list args;
+    char    *msg;
+
+    if (r->error) {
+        return;
+    }
+    r->error = true;
+    r->token = SYSD_MT_ERROR;
+
+    va_start(args, format);
+    msg = xvasprintf(format, args);
+    va_end(args);
+
+    if (r->path.length) {
+        VLOG_ERR("%s:%d:%d: %s (at %s)", r->file_name, r->tok_line,
+                 r->tok_column, msg, ds_cstr(&r->path));
+    } else {
+        VLOG_ERR("%s:%d:%d: %s", r->file_name, r->tok_line,
+                 r->tok_column, msg);
+    }
+    free(msg);
+
+} /* sysd_manifest_error */
+
+static void
+sysd_manifest_getc(struct sysd_manifest_reader *r)
+{
+    if (r->c == '\n') {
+        r->line++;
+        r->column = 1;
+    } else if (r->c != EOF) {
+        r->column++;
+    }
+    /* The stream is private to the reader. */
+    r->c = getc_unlocked(r->stream);
+
+} /* sysd_manifest_getc */
+
+static bool
+sysd_manifest_lex_literal(struct sysd_manifest_reader *r, const char *word,
+                          enum sysd_manifest_token token)
+{
+    const char *p;
+
+    for (p = word; *p; p++) {
+        if (r->c != *p) {
+            sysd_manifest_error(r, "invalid literal, expected '%s'", word);
+            return false;
+        }
+        sysd_manifest_getc(r);
+    }
+    r->token = token;
+
+    return true;
+
+} /* sysd_manifest_lex_literal */
+
+static bool
+sysd_manifest_lex_number(struct sysd_manifest_reader *r)
+{
+    char    buf[64];
+    char    *end;
+    size_t  n = 0;
+    bool    is_real = false;
+
+    while ((r->c >= '0' && r->c <= '9') || r->c == '-' || r->c == '+'
+           || r->c == '.' || r->c == 'e' || r->c == 'E') {
+        if (n >= sizeof buf - 1) {
+            sysd_manifest_error(r, "number is too long");
+            return false;
+        }
+        if (r->c == '.' || r->c == 'e' || r->c == 'E') {
+            is_real = true;
+        }
+        buf[n++] = r->c;
+        sysd_manifest_getc(r);
+    }
+    buf[n] = '\0';
+
+    errno = 0;
+    if (is_real) {
+        r->real = strtod(buf, &end);
+        r->token = SYSD_MT_REAL;
+    } else {
+        r->integer = strtoll(buf, &end, 10);
+        r->token = SYSD_MT_INTEGER;
+    }
+
+    if (*end != '\0' || end == buf || buf[0] == '+') {
+        sysd_manifest_error(r, "invalid number '%s'", buf);
+        return false;
+    } else if (errno == ERANGE) {
+        sysd_manifest_error(r, "number '%s' is out of range", buf);
+        return false;
+    }
+
+    return true;
+
+} /* sysd_manifest_lex_number */
+
+/* Reads the 4 hex digits of a \u escape. */
+static bool
+sysd_manifest_lex_hex4(struct sysd_manifest_reader *r, int *value)
+{
+    int i;
+
+    *value = 0;
+    for (i = 0; i < 4; i++) {
+        sysd_manifest_getc(r);
+        if (r->c >= '0' && r->c <= '9') {
+            *value = *value * 16 + (r->c - '0');
+        } else if (r->c >= 'a' && r->c <= 'f') {
+            *value = *value * 16 + (r->c - 'a' + 10);
+        } else if (r->c >= 'A' && r->c <= 'F') {
+            *value = *value * 16 + (r->c - 'A' + 10);
+        } else {
+            sysd_manifest_error(r, "invalid \\u escape in string");
+            return false;
+        }
+    }
+
+    return true;
+
+} /* sysd_manifest_lex_hex4 */
+
+static bool
+sysd_manifest_lex_string(struct sysd_manifest_reader *r)
+{
+    int     uc, lo;
+
+    ds_clear(&r->string);
+
+    /* Skip the opening quote. */
+    sysd_manifest_getc(r);
+
+    for (;;) {
+        if (r->c == EOF) {
+            sysd_manifest_error(r, "unterminated string");
+            return false;
+        } else if (r->c == '"') {
+            sysd_manifest_getc(r);
+            break;
+        } else if ((unsigned char) r->c < 0x20) {
+            sysd_manifest_error(r, "control character in string");
+            return false;
+        } else if (r->c != '\\') {
+            ds_put_char(&r->string, r->c);
+            sysd_manifest_getc(r);
+            continue;
+        }
+
+        sysd_manifest_getc(r);
+        switch (r->c) {
+        case '"':
+        case '\\':
+        case '/':
+            ds_put_char(&r->string, r->c);
+            break;
+        case 'b':
+            ds_put_char(&r->string, '\b');
+            break;
+        case 'f':
+            ds_put_char(&r->string, '\f');
+            break;
+        case 'n':
+            ds_put_char(&r->string, '\n');
+            break;
+        case 'r':
+            ds_put_char(&r->string, '\r');
+            break;
+        case 't':
+            ds_put_char(&r->string, '\t');
+            break;
+        case 'u':
+            if (!sysd_manifest_lex_hex4(r, &uc)) {
+                return false;
+            }
+            if (uc >= 0xd800 && uc <= 0xdbff) {
+                /* High surrogate, must be followed by a low one. */
+                sysd_manifest_getc(r);
+                if (r->c != '\\') {
+                    sysd_manifest_error(r, "unpaired surrogate in string");
+                    return false;
+                }
+                sysd_manifest_getc(r);
+                if (r->c != 'u' || !sysd_manifest_lex_hex4(r, &lo)
+                    || lo < 0xdc00 || lo > 0xdfff) {
+                    sysd_manifest_error(r, "unpaired surrogate in string");
+                    return false;
+                }
+                uc = 0x10000 + ((uc - 0xd800) << 10) + (lo - 0xdc00);
+            } else if (uc >= 0xdc00 && uc <= 0xdfff) {
+                sysd_manifest_error(r, "unpaired surrogate in string");
+                return false;
+            }
+            ds_put_utf8(&r->string, uc);
+            break;
+        default:
+            sysd_manifest_error(r, "invalid escape in string");
+            return false;
+        }
+        sysd_manifest_getc(r);
+    }
+
+    r->token = SYSD_MT_STRING;
+
+    return true;
+
+} /* sysd_manifest_lex_string */
+
+/* Reads the next token into 'r'. Returns false on error. */
+static bool
+sysd_manifest_next(struct sysd_manifest_reader *r)
+{
+    if (r->error) {
+        return false;
+    }
+
+    while (r->c == ' ' || r->c == '\t' || r->c == '\n' || r->c == '\r') {
+        sysd_manifest_getc(r);
+    }
+
+    r->tok_line = r->line;
+    r->tok_column = r->column;
+
+    switch (r->c) {
+    case EOF:
+        if (ferror(r->stream)) {
+            sysd_manifest_error(r, "read error: %s", ovs_strerror(errno));
+            return false;
+        }
+        r->token = SYSD_MT_EOF;
+        return true;
+    case '{':
+        r->token = SYSD_MT_BEGIN_OBJECT;
+        break;
+    case '}':
+        r->token = SYSD_MT_END_OBJECT;
+        break;
+    case '[':
+        r->token = SYSD_MT_BEGIN_ARRAY;
+        break;
+    case ']':
+        r->token = SYSD_MT_END_ARRAY;
+        break;
+    case ':':
+        r->token = SYSD_MT_COLON;
+        break;
+    case ',':
+        r->token = SYSD_MT_COMMA;
+        break;
+    case '"':
+        return sysd_manifest_lex_string(r);
+    case 't':
+        return sysd_manifest_lex_literal(r, "true", SYSD_MT_TRUE);
+    case 'f':
+        return sysd_manifest_lex_literal(r, "false", SYSD_MT_FALSE);
+    case 'n':
+        return sysd_manifest_lex_literal(r, "null", SYSD_MT_NULL);
+    default:
+        if (r->c == '-' || (r->c >= '0' && r->c <= '9')) {
+            return sysd_manifest_lex_number(r);
+        }
+        sysd_manifest_error(r, "unexpected character '%c'", r->c);
+        return false;
+    }
+
+    sysd_manifest_getc(r);
+
+    return true;
+
+} /* sysd_manifest_next */
+
+/* Calls 'cb' for every member of the object starting at the current token.
+ * 'cb' is called with the current token on the first token of the member
+ * value and must consume the whole value. On return the current token is
+ * the one following the object. */
+static bool
+sysd_manifest_object(struct sysd_manifest_reader *r, const char *what,
+                     sysd_manifest_member_cb *cb, void *aux)
+{
+    size_t  path_len = r->path.length;
+    char    *name;
+    bool    ok;
+
+    if (r->token != SYSD_MT_BEGIN_OBJECT) {
+        sysd_manifest_error(r, "%s must be an object", what);
+        return false;
+    }
+
+    if (!sysd_manifest_next(r)) {
+        return false;
+    }
+    if (r->token == SYSD_MT_END_OBJECT) {
+        return sysd_manifest_next(r);
+    }
+
+    for (;;) {
+        if (r->token != SYSD_MT_STRING) {
+            sysd_manifest_error(r, "expected member name in %s", what);
+            return false;
+        }
+        /* Copy rather than steal, so 'string' keeps its buffer. */
+        name = xstrdup(ds_cstr(&r->string));
+
+        if (!sysd_manifest_next(r) || r->token != SYSD_MT_COLON) {
+            sysd_manifest_error(r, "expected ':' after member name '%s'",
+                                name);
+            free(name);
+            return false;
+        }
+
+        if (path_len) {
+            ds_put_char(&r->path, '.');
+        }
+        ds_put_cstr(&r->path, name);
+        ok = sysd_manifest_next(r) && cb(r, name, aux);
+        ds_truncate(&r->path, path_len);
+        free(name);
+        if (!ok) {
+            return false;
+        }
+
+        if (r->token == SYSD_MT_END_OBJECT) {
+            return sysd_manifest_next(r);
+        } else if (r->token != SYSD_MT_COMMA) {
+            sysd_manifest_error(r, "expected ',' or '}' in %s", what);
+            return false;
+        }
+        if (!sysd_manifest_next(r)) {
+            return false;
+        }
+    }
+
+} /* sysd_manifest_object */
+
+/* Same as sysd_manifest_object() for the elements of an array. */
+static bool
+sysd_manifest_array(struct sysd_manifest_reader *r, const char *what,
+                    sysd_manifest_element_cb *cb, void *aux)
+{
+    size_t  path_len = r->path.length;
+    size_t  idx = 0;
+    bool    ok;
+
+    if (r->token != SYSD_MT_BEGIN_ARRAY) {
+        sysd_manifest_error(r, "%s must be an array", what);
+        return false;
+    }
+
+    if (!sysd_manifest_next(r)) {
+        return false;
+    }
+    if (r->token == SYSD_MT_END_ARRAY) {
+        return sysd_manifest_next(r);
+    }
+
+    for (;;) {
+        ds_put_format(&r->path, "[%"PRIuSIZE"]", idx);
+        ok = cb(r, idx++, aux);
+        ds_truncate(&r->path, path_len);
+        if (!ok) {
+            return false;
+        }
+
+        if (r->token == SYSD_MT_END_ARRAY) {
+            return sysd_manifest_next(r);
+        } else if (r->token != SYSD_MT_COMMA) {
+            sysd_manifest_error(r, "expected ',' or ']' in %s", what);
+            return false;
+        }
+        if (!sysd_manifest_next(r)) {
+            return false;
+        }
+    }
+
+} /* sysd_manifest_array */
+
+static bool sysd_manifest_skip(struct sysd_manifest_reader *);
+
+static bool
+sysd_manifest_skip_member(struct sysd_manifest_reader *r,
+                          const char *name OVS_UNUSED, void *aux OVS_UNUSED)
+{
+    return sysd_manifest_skip(r);
+
+} /* sysd_manifest_skip_member */
+
+static bool
+sysd_manifest_skip_element(struct sysd_manifest_reader *r,
+                           size_t idx OVS_UNUSED, void *aux OVS_UNUSED)
+{
+    return sysd_manifest_skip(r);
+
+} /* sysd_manifest_skip_element */
+
+/* Consumes the value starting at the current token without looking at it,
+ * other than checking that it is well formed. */
+static bool
+sysd_manifest_skip(struct sysd_manifest_reader *r)
+{
+    switch (r->token) {
+    case SYSD_MT_BEGIN_OBJECT:
+        return sysd_manifest_object(r, "object", sysd_manifest_skip_member,
+                                    NULL);
+    case SYSD_MT_BEGIN_ARRAY:
+        return sysd_manifest_array(r, "array", sysd_manifest_skip_element,
+                                   NULL);
+    case SYSD_MT_STRING:
+    case SYSD_MT_INTEGER:
+    case SYSD_MT_REAL:
+    case SYSD_MT_TRUE:
+    case SYSD_MT_FALSE:
+    case SYSD_MT_NULL:
+        return sysd_manifest_next(r);
+    default:
+        sysd_manifest_error(r, "expected a value");
+        return false;
+    }
+
+} /* sysd_manifest_skip */
+
+static bool
+sysd_manifest_get_bool(struct sysd_manifest_reader *r, const char *name,
+                       bool *value)
+{
+    if (r->token != SYSD_MT_TRUE && r->token != SYSD_MT_FALSE) {
+        sysd_manifest_error(r, "'%s' must be true or false", name);
+        return false;
+    }
+    *value = (r->token == SYSD_MT_TRUE);
+
+    return sysd_manifest_next(r);
+
+} /* sysd_manifest_get_bool */
+
+/* Reads a non-negative number of seconds into '*msec'. */
+static bool
+sysd_manifest_get_seconds(struct sysd_manifest_reader *r, const char *name,
+                          long long int *msec)
+{
+    if (r->token == SYSD_MT_INTEGER && r->integer >= 0
+        && r->integer <= LLONG_MAX / 1000) {
+        *msec = r->integer * 1000;
+    } else if (r->token == SYSD_MT_REAL && r->real >= 0
+               && r->real <= LLONG_MAX / 1000) {
+        *msec = (long long int) (r->real * 1000);
+    } else {
+        sysd_manifest_error(r, "'%s' must be a number of seconds", name);
+        return false;
+    }
+
+    return sysd_manifest_next(r);
+
+} /* sysd_manifest_get_seconds */
+
+static bool
+sysd_manifest_depends_on_element(struct sysd_manifest_reader *r,
+                                 size_t idx OVS_UNUSED, void *daemon_)
+{
+    daemon_info_t *daemon = daemon_;
+
+    if (r->token != SYSD_MT_STRING) {
+        sysd_manifest_error(r, "'%s' must list daemon names",
+                            DEPENDS_ON_TAG);
+        return false;
+    }
+    sysd_daemon_add_dependency(&daemon_registry, daemon,
+                               ds_cstr(&r->string));
+
+    return sysd_manifest_next(r);
+
+} /* sysd_manifest_depends_on_element */
+
+static bool
+sysd_manifest_daemon_member(struct sysd_manifest_reader *r, const char *name,
+                            void *daemon_)
+{
+    daemon_info_t *daemon = daemon_;
+
+    if (!strcmp(name, HW_HANDLER_TAG)) {
+        return sysd_manifest_get_bool(r, name, &daemon->is_hw_handler);
+    } else if (!strcmp(name, STAGE_TAG)) {
+        if (r->token != SYSD_MT_STRING) {
+            sysd_manifest_error(r, "'%s' must be a string", name);
+            return false;
+        }
+        sysd_daemon_set_stage(&daemon_registry, daemon, ds_cstr(&r->string));
+        return sysd_manifest_next(r);
+    } else if (!strcmp(name, DEPENDS_ON_TAG)) {
+        return sysd_manifest_array(r, "'" DEPENDS_ON_TAG "'",
+                                   sysd_manifest_depends_on_element, daemon);
+    } else if (!strcmp(name, READY_TIMEOUT_TAG)) {
+        return sysd_manifest_get_seconds(r, name,
+                                         &daemon->ready_timeout_msec);
+    }
+
+    /* Per daemon metadata that sysd does not use. */
+    return sysd_manifest_skip(r);
+
+} /* sysd_manifest_daemon_member */
+
+static bool
+sysd_manifest_daemon(struct sysd_manifest_reader *r, const char *name,
+                     void *aux OVS_UNUSED)
+{
+    daemon_info_t *daemon;
+
+    if (r->token != SYSD_MT_BEGIN_OBJECT) {
+        sysd_manifest_error(r, "daemon '%s' must be an object", name);
+        return false;
+    }
+
+    daemon = sysd_daemon_registry_add(&daemon_registry, name);
+
+    /* If this row is sysd, then go ahead and set cur_hw = 1 since
+       ...everything is being done in one transaction. */
+    daemon->cur_hw = (strcmp(daemon->name, NAME_IN_DAEMON_TABLE) == 0);
+
+    if (!sysd_manifest_object(r, "daemon", sysd_manifest_daemon_member,
+                              daemon)) {
+        return false;
+    }
+
+    VLOG_INFO("daemons_manifest:'%s', daemons_manifest_cur_hw %d, "
+              "daemons_manifest_is_hw_handler %d", daemon->name,
+              (int)(daemon->cur_hw), (int)(daemon->is_hw_handler));
+
+    return true;
+
+} /* sysd_manifest_daemon */
+
+static bool
+sysd_manifest_readiness_member(struct sysd_manifest_reader *r,
+                               const char *name, void *aux OVS_UNUSED)
+{
+    if (!strcmp(name, READINESS_DEFAULT_TIMEOUT_TAG)) {
+        return sysd_manifest_get_seconds(r, name,
+                                         &daemon_registry.default_timeout_msec);
+    } else if (!strcmp(name, READINESS_QUORUM_TAG)) {
+        if (r->token != SYSD_MT_INTEGER || r->integer < 0) {
+            sysd_manifest_error(r, "'%s' must be a number of daemons", name);
+            return false;
+        }
+        daemon_registry.quorum = r->integer;
+        return sysd_manifest_next(r);
+    }
+
+    return sysd_manifest_skip(r);
+
+} /* sysd_manifest_readiness_member */
+
+static bool
+sysd_manifest_mgmt_intf_member(struct sysd_manifest_reader *r,
+                               const char *name, void *aux OVS_UNUSED)
+{
+    if (strcmp(name, MGMT_INTF_NAME_TAG)) {
+        return sysd_manifest_skip(r);
+    }
+
+    if (r->token != SYSD_MT_STRING || r->string.length == 0) {
+        sysd_manifest_error(r, "'%s' must be an interface name", name);
+        return false;
+    } else if (r->string.length >= MAX_MGMT_INTF_NAME_LEN) {
+        sysd_manifest_error(r, "interface name is longer than %d characters",
+                            MAX_MGMT_INTF_NAME_LEN - 1);
+        return false;
+    }
+
+    if (mgmt_intf == NULL) {
+        mgmt_intf = sysd_arena_alloc(&sysd_boot_arena, sizeof *mgmt_intf);
+    }
+    ovs_strlcpy(mgmt_intf->name, ds_cstr(&r->string), sizeof mgmt_intf->name);
+    VLOG_DBG("Management Interface read successfully: %s", mgmt_intf->name);
+
+    return sysd_manifest_next(r);
+
+} /* sysd_manifest_mgmt_intf_member */
+
+static bool
+sysd_manifest_top_member(struct sysd_manifest_reader *r, const char *name,
+                         void *aux OVS_UNUSED)
+{
+    if (!strcmp(name, DAEMONS_TAG)) {
+        return sysd_manifest_object(r, "'" DAEMONS_TAG "'",
+                                    sysd_manifest_daemon, NULL);
+    } else if (!strcmp(name, READINESS_TAG)) {
+        return sysd_manifest_object(r, "'" READINESS_TAG "'",
+                                    sysd_manifest_readiness_member, NULL);
+    } else if (!strcmp(name, MGMT_INTF_TAG)) {
+        return sysd_manifest_object(r, "'" MGMT_INTF_TAG "'",
+                                    sysd_manifest_mgmt_intf_member, NULL);
+    }
+
+    return sysd_manifest_skip(r);
+
+} /* sysd_manifest_top_member */
+
+/* Reads the image.manifest content from 'stream' into the daemon registry
+ * and 'mgmt_intf'. 'file_name' is only used in error messages. Returns 0
+ * on success, -1 if the manifest is malformed. */
+int
+sysd_manifest_read_stream(FILE *stream, const char *file_name)
+{
+    struct sysd_manifest_reader r;
+    bool    ok;
+
+    memset(&r, 0, sizeof r);
+    r.stream = stream;
+    r.file_name = file_name;
+    r.line = 1;
+    r.column = 0;
+    r.c = '\0';
+    ds_init(&r.string);
+    ds_init(&r.path);
+
+    sysd_manifest_getc(&r);
+
+    ok = (sysd_manifest_next(&r)
+          && sysd_manifest_object(&r, "image.manifest",
+                                  sysd_manifest_top_member, NULL));
+    if (ok && r.token != SYSD_MT_EOF) {
+        sysd_manifest_error(&r, "unexpected data after the manifest");
+        ok = false;
+    }
+    if (ok && mgmt_intf == NULL) {
+        sysd_manifest_error(&r, "'%s' with an '%s' member is missing",
+                            MGMT_INTF_TAG, MGMT_INTF_NAME_TAG);
+        ok = false;
+    }
+
+    ds_destroy(&r.string);
+    ds_destroy(&r.path);
+
+    return ok ? 0 : -1;
+
+} /* sysd_manifest_read_stream */
+
+int
+sysd_manifest_read_file(const char *file_name)
+{
+    FILE    *stream;
+    int     rc;
+
+    stream = fopen(file_name, "r");
+    if (stream == NULL) {
+        VLOG_ERR("Unable to open %s. Error %s", file_name,
+                 ovs_strerror(errno));
+        return -1;
+    }
+
+    rc = sysd_manifest_read_stream(stream, file_name);
+    fclose(stream);
+
+    return rc;
+
+} /* sysd_manifest_read_file */
+/** @} end of group sysd */
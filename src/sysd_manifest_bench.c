@@ -0,0 +1,254 @@
+/************************************************************************//**
+ * (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *    License for the specific language governing permissions and limitations
+ *    under the License.
+ *
+ ***************************************************************************/
+/* @ingroup sysd
+ *
+ * @file
+ * Benchmark for the sysd image.manifest reader.
+ *
+ * Generates a manifest with a configurable number of daemons, each
+ * carrying dependencies and extra metadata sysd does not use, and times
+ * the streaming reader against building the full JSON tree with
+ * json_from_file(), which is what sysd did before.
+ *
+ * It also times the daemon registry on its own, one phase at a time:
+ * adding the daemons, looking each of them up by name, resolving the
+ * dependency graph and evaluating readiness with every Daemon row bound.
+ *
+ *   ops-sysd-manifest-bench [n_daemons] [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <util.h>
+#include <json.h>
+
+#include <vswitch-idl.h>
+
+#include "sysd_util.h"
+#include "sysd_manifest.h"
+#include "sysd_daemon.h"
+#include "sysd_arena.h"
+
+/* Normally defined in sysd.c; the reader fills it in. */
+mgmt_intf_info_t *mgmt_intf = NULL;
+
+static long long
+bench_now_nsec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+
+} /* bench_now_nsec */
+
+static void
+bench_write_manifest(FILE *fp, int n_daemons)
+{
+    int i;
+
+    fprintf(fp, "{\n  \"%s\": {\n", DAEMONS_TAG);
+    for (i = 0; i < n_daemons; i++) {
+        fprintf(fp, "    \"ops-bench-%d\": {\n"
+                "      \"%s\": %s,\n"
+                "      \"%s\": \"stage-%d\",\n",
+                i,
+                HW_HANDLER_TAG, (i % 3) ? "false" : "true",
+                STAGE_TAG, i % 8);
+
+        /* Only on earlier daemons, so the graph has no cycle. */
+        if (i > 0) {
+            fprintf(fp, "      \"%s\": [\"ops-bench-%d\"", DEPENDS_ON_TAG,
+                    i / 2);
+            if (i / 3 != i / 2) {
+                fprintf(fp, ", \"ops-bench-%d\"", i / 3);
+            }
+            fprintf(fp, "],\n");
+        }
+
+        fprintf(fp, "      \"%s\": 2.5,\n"
+                "      \"description\": \"generated daemon %d\",\n"
+                "      \"restart\": {\"policy\": \"always\", "
+                "\"limits\": [1, 2, 3, 4, 5]}\n"
+                "    }%s\n",
+                READY_TIMEOUT_TAG,
+                i,
+                (i + 1 < n_daemons) ? "," : "");
+    }
+    fprintf(fp, "  },\n"
+            "  \"%s\": {\"%s\": 60, \"%s\": 1},\n"
+            "  \"%s\": {\"%s\": \"eth0\"}\n"
+            "}\n",
+            READINESS_TAG, READINESS_DEFAULT_TIMEOUT_TAG,
+            READINESS_QUORUM_TAG, MGMT_INTF_TAG, MGMT_INTF_NAME_TAG);
+
+} /* bench_write_manifest */
+
+static void
+bench_registry(int n_daemons, int iterations)
+{
+    long long           add_nsec = 0, find_nsec = 0;
+    long long           graph_nsec = 0, ready_nsec = 0, start;
+    sysd_daemon_registry_t reg;
+    struct ovsrec_daemon *rows;
+    daemon_info_t       *daemon;
+    char                **names;
+    char                stage[32];
+    size_t              n_found = 0;
+    int                 i, j;
+
+    names = xmalloc(n_daemons * sizeof *names);
+    for (i = 0; i < n_daemons; i++) {
+        names[i] = xasprintf("ops-bench-%d", i);
+    }
+
+    /* Every h/w daemon has set cur_hw, so readiness walks the whole
+     * dependency graph. */
+    rows = xcalloc(n_daemons, sizeof *rows);
+    for (i = 0; i < n_daemons; i++) {
+        rows[i].cur_hw = 1;
+    }
+
+    for (j = 0; j < iterations; j++) {
+        sysd_daemon_registry_init(&reg);
+
+        start = bench_now_nsec();
+        for (i = 0; i < n_daemons; i++) {
+            sysd_daemon_registry_add(&reg, names[i]);
+        }
+        add_nsec += bench_now_nsec() - start;
+
+        /* Same shape as the generated manifest. */
+        for (i = 0; i < n_daemons; i++) {
+            daemon = &reg.daemons[i];
+            daemon->is_hw_handler = (i % 3) == 0;
+            daemon->row = &rows[i];
+            snprintf(stage, sizeof stage, "stage-%d", i % 8);
+            sysd_daemon_set_stage(&reg, daemon, stage);
+            if (i > 0) {
+                sysd_daemon_add_dependency(&reg, daemon, names[i / 2]);
+                if (i / 3 != i / 2) {
+                    sysd_daemon_add_dependency(&reg, daemon, names[i / 3]);
+                }
+            }
+        }
+
+        start = bench_now_nsec();
+        for (i = 0; i < n_daemons; i++) {
+            n_found += sysd_daemon_registry_find(&reg, names[i]) != NULL;
+        }
+        find_nsec += bench_now_nsec() - start;
+
+        start = bench_now_nsec();
+        if (sysd_daemon_registry_build_graph(&reg)) {
+            fprintf(stderr, "Dependency cycle in the generated registry\n");
+            exit(1);
+        }
+        graph_nsec += bench_now_nsec() - start;
+
+        start = bench_now_nsec();
+        sysd_daemon_registry_eval_ready(&reg);
+        ready_nsec += bench_now_nsec() - start;
+
+        sysd_daemon_registry_destroy(&reg);
+    }
+
+    if (n_found != (size_t) n_daemons * iterations) {
+        fprintf(stderr, "Registry lost daemons: found %"PRIuSIZE" of %d\n",
+                n_found, n_daemons * iterations);
+        exit(1);
+    }
+
+    printf("  registry add:       %10.3f ms/iteration\n",
+           add_nsec / 1e6 / iterations);
+    printf("  registry find:      %10.3f ms/iteration (%d lookups)\n",
+           find_nsec / 1e6 / iterations, n_daemons);
+    printf("  registry graph:     %10.3f ms/iteration\n",
+           graph_nsec / 1e6 / iterations);
+    printf("  registry readiness: %10.3f ms/iteration\n",
+           ready_nsec / 1e6 / iterations);
+
+    for (i = 0; i < n_daemons; i++) {
+        free(names[i]);
+    }
+    free(names);
+    free(rows);
+
+} /* bench_registry */
+
+int
+main(int argc, char *argv[])
+{
+    char        file_name[] = "/tmp/sysd-manifest-bench-XXXXXX";
+    int         n_daemons = (argc > 1) ? atoi(argv[1]) : 10000;
+    int         iterations = (argc > 2) ? atoi(argv[2]) : 10;
+    long long   stream_nsec = 0, tree_nsec = 0, start;
+    FILE        *fp;
+    int         fd, i;
+
+    if (n_daemons < 1 || iterations < 1) {
+        fprintf(stderr, "usage: %s [n_daemons] [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    fd = mkstemp(file_name);
+    if (fd < 0 || (fp = fdopen(fd, "w")) == NULL) {
+        fprintf(stderr, "Unable to create %s\n", file_name);
+        return 1;
+    }
+    bench_write_manifest(fp, n_daemons);
+    fclose(fp);
+
+    for (i = 0; i < iterations; i++) {
+        struct json *json;
+
+        sysd_daemon_registry_destroy(&daemon_registry);
+        sysd_daemon_registry_init(&daemon_registry);
+
+        start = bench_now_nsec();
+        if (sysd_manifest_read_file(file_name)) {
+            fprintf(stderr, "Streaming reader failed on %s\n", file_name);
+            unlink(file_name);
+            return 1;
+        }
+        stream_nsec += bench_now_nsec() - start;
+
+        /* sysd used to free the tree right after reading it. */
+        start = bench_now_nsec();
+        json = json_from_file(file_name);
+        json_destroy(json);
+        tree_nsec += bench_now_nsec() - start;
+    }
+    unlink(file_name);
+
+    printf("%d daemons, %d iterations\n", n_daemons, iterations);
+    printf("  streaming reader:   %10.3f ms/iteration\n",
+           stream_nsec / 1e6 / iterations);
+    printf("  json_from_file:     %10.3f ms/iteration (tree build and free)\n",
+           tree_nsec / 1e6 / iterations);
+
+    bench_registry(n_daemons, iterations);
+
+    sysd_daemon_registry_destroy(&daemon_registry);
+    sysd_arena_destroy(&sysd_boot_arena);
+
+    return 0;
+
+} /* main */
@@ -29,10 +29,14 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <coverage.h>
 #include <daemon.h>
 #include <dirs.h>
 #include <smap.h>
 #include <shash.h>
+#include <simap.h>
+#include <dynamic-string.h>
+#include <json.h>
 #include <poll-loop.h>
 #include <ovsdb-idl.h>
 #include <openswitch-idl.h>
@@ -48,6 +52,9 @@
 #include "sysd.h"
 #include "sysd_util.h"
 #include "sysd_ovsdb_if.h"
+#include "sysd_readiness.h"
+#include "sysd_reconcile.h"
+#include "sysd_loop.h"
 #include "eventlog.h"
 
 #include <errno.h>
@@ -55,10 +62,34 @@
 
 VLOG_DEFINE_THIS_MODULE(ovsdb_if);
 
+COVERAGE_DEFINE(sysd_run);
+COVERAGE_DEFINE(sysd_seqno_changed);
+COVERAGE_DEFINE(sysd_readiness_eval);
+COVERAGE_DEFINE(sysd_os_release_parse);
+COVERAGE_DEFINE(sysd_timezone_apply);
+COVERAGE_DEFINE(sysd_pkg_info_row);
+COVERAGE_DEFINE(sysd_txn_initial_commit);
+COVERAGE_DEFINE(sysd_txn_initial_fail);
+COVERAGE_DEFINE(sysd_txn_reconcile_commit);
+COVERAGE_DEFINE(sysd_txn_reconcile_fail);
+COVERAGE_DEFINE(sysd_txn_pkg_info_commit);
+COVERAGE_DEFINE(sysd_txn_pkg_info_fail);
+COVERAGE_DEFINE(sysd_txn_hw_done_commit);
+COVERAGE_DEFINE(sysd_txn_hw_done_fail);
+COVERAGE_DEFINE(sysd_txn_hw_gen_commit);
+COVERAGE_DEFINE(sysd_txn_hw_gen_fail);
+COVERAGE_DEFINE(sysd_txn_readiness_commit);
+COVERAGE_DEFINE(sysd_txn_readiness_fail);
+
+/* Counts the outcome of a transaction commit at call site 'SITE'. */
+#define SYSD_TXN_COVERAGE(SITE, STATUS)                             \
+    (((STATUS) == TXN_SUCCESS || (STATUS) == TXN_UNCHANGED)         \
+     ? COVERAGE_INC(sysd_txn_##SITE##_commit)                       \
+     : COVERAGE_INC(sysd_txn_##SITE##_fail))
+
 /** @ingroup sysd
  * @{ */
 #define PKG_INFO_ENTRIES_PER_COMMIT 2000
-#define REM_BUF_LEN (buflen - 1 - strlen(buf))
 
 enum {
     VALUE,
@@ -83,347 +114,9 @@ extern char *g_hw_desc_dir;
 
 static bool hw_init_done_set = false;
 
-void
-sysd_get_speeds_string(char *speed_str, int len, int **speeds)
-{
-    int     i = 0;
-    char    buf[10];
-
-    while(speeds[i] != NULL) {
-        if (i == 0) {
-            snprintf(buf, sizeof(buf), "%d", *speeds[i]);
-        } else {
-            snprintf(buf, sizeof(buf), ",%d", *speeds[i]);
-        }
-        strncat(speed_str, buf, len);
-        i++;
-    }
-} /* sysd_get_speeds_string */
-
-struct ovsrec_interface *
-sysd_initial_interface_add(struct ovsdb_idl_txn *txn,
-                           sysd_subsystem_t *subsys_ptr,
-                           sysd_intf_info_t *intf_ptr)
-{
-    char                        *tmp_p;
-    char                        buf[128];
-    struct ovsrec_interface     *ovs_intf = NULL;
-    struct smap                 hw_intf_info;
-    char                        **cap_p;
-
-    ovs_intf = ovsrec_interface_insert(txn);
-
-    ovsrec_interface_set_name(ovs_intf, intf_ptr->name);
-
-    ovsrec_interface_set_type(ovs_intf, OVSREC_INTERFACE_TYPE_SYSTEM);
-
-    ovsrec_interface_set_admin_state(ovs_intf, OVSREC_INTERFACE_ADMIN_STATE_DOWN);
-
-    smap_init(&hw_intf_info);
-
-    tmp_p = (intf_ptr->pluggable) ? INTERFACE_HW_INTF_INFO_MAP_PLUGGABLE_TRUE
-        : INTERFACE_HW_INTF_INFO_MAP_PLUGGABLE_FALSE;
-    smap_add(&hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_PLUGGABLE, tmp_p);
-    smap_add(&hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_CONNECTOR, intf_ptr->connector);
-
-    smap_add_format(&hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_MAX_SPEED,
-                    "%d", intf_ptr->max_speed);
-
-    memset(buf, 0, sizeof(buf));
-    sysd_get_speeds_string(buf, sizeof(buf), intf_ptr->speeds);
-    smap_add(&hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_SPEEDS, buf);
-
-
-    smap_add_format(&hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_SWITCH_UNIT,
-                    "%d", intf_ptr->device);
-    smap_add_format(&hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_SWITCH_INTF_ID,
-                    "%d", intf_ptr->device_port);
-
-    /* Add interface capabilities
-     * Check for known values and add them. If an unknown capability is given,
-     * log (info) it and go ahead and add it.
-    */
-    cap_p = intf_ptr->capabilities;
-
-    while (*cap_p != (char *) NULL) {
-        if ((strcmp(*cap_p, INTERFACE_HW_INTF_INFO_MAP_SPLIT_4) != 0)  &&
-            (strcmp(*cap_p, INTERFACE_HW_INTF_INFO_MAP_ENET1G)  != 0)  &&
-            (strcmp(*cap_p, INTERFACE_HW_INTF_INFO_MAP_ENET10G) != 0)  &&
-            (strcmp(*cap_p, INTERFACE_HW_INTF_INFO_MAP_ENET25G) != 0)  &&
-            (strcmp(*cap_p, INTERFACE_HW_INTF_INFO_MAP_ENET40G) != 0)  &&
-            (strcmp(*cap_p, INTERFACE_HW_INTF_INFO_MAP_ENET100G) != 0)) {
-
-            VLOG_INFO("subsystem[%s]:interface[%s] - adding unknown "
-                      "interface capability[%s]",
-                             subsys_ptr->name, intf_ptr->name, *cap_p);
-        }
-
-        smap_add(&hw_intf_info, *cap_p, "true");
-        cap_p++;
-    }
-
-    /* All the interfaces in a subsystem uses the same MAC address.
-     * Copy the subsystem system MAC to interface hw_info:mac_addres.
-     */
-    if (subsys_ptr->system_mac_addr) {
-        memset(buf, 0, sizeof(buf));
-        tmp_p = ops_ether_ulong_long_to_string(buf, subsys_ptr->system_mac_addr);
-        smap_add(&hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_MAC_ADDR, tmp_p);
-    }
-
-    ovsrec_interface_set_hw_intf_info(ovs_intf, &hw_intf_info);
-    smap_destroy(&hw_intf_info);
-
-    /*
-     * OPS_TODO:
-     * Current schema has in-correct values for interface table.
-     * Once we fix all that, need to fix the following code.
-     *
-     * unsigned int                speed_count = 0;
-     * ovsrec_interface_set_connector(ovs_intf, intf_ptr->connector);
-     * ovsrec_interface_set_max_speed(ovs_intf, &(intf_ptr->max_speed), 1);
-     * speed_count = get_count_null_ended((void *) intf_ptr->speeds);
-     * ovsrec_interface_set_link_speed(ovs_intf, intf_ptr->speeds, speed_count); */
-
-    return ovs_intf;
-
-} /* sysd_initial_interface_add */
-
-void
-sysd_set_splittable_port_info(struct ovsrec_interface **ovs_intf, sysd_subsystem_t *subsys_ptr)
-{
-    int                 i = 0;
-    sysd_intf_info_t    *intf_ptr = NULL;
-    struct shash        ovs_intf_shash = SHASH_INITIALIZER(&ovs_intf_shash);
-
-    for (i = 0; i < subsys_ptr->intf_count; i++) {
-        intf_ptr = subsys_ptr->interfaces[i];
-
-        if ((intf_ptr->subports[0] != NULL) ||
-            (intf_ptr->parent_port != NULL)) {
-
-            shash_add(&ovs_intf_shash, ovs_intf[i]->name, ovs_intf[i]);
-        }
-    }
-
-    for (i = 0; i < subsys_ptr->intf_count; i++) {
-        intf_ptr = subsys_ptr->interfaces[i];
-
-        if (intf_ptr->parent_port != NULL) {
-            struct ovsrec_interface *parent = NULL;
-
-            parent = shash_find_data(&ovs_intf_shash, intf_ptr->parent_port);
-            if (parent != NULL) {
-                ovsrec_interface_set_split_parent(ovs_intf[i], parent);
-            } else {
-                VLOG_WARN("Unable to find parent port %s of subport %s",
-                          intf_ptr->parent_port, intf_ptr->name);
-            }
-        }
-
-        if (intf_ptr->subports[0] != NULL) {
-            struct ovsrec_interface *subports[SYSD_MAX_SPLIT_PORTS];
-            int j = 0, k = 0;
-
-            while(intf_ptr->subports[k] != NULL) {
-                subports[j] = shash_find_data(&ovs_intf_shash, intf_ptr->subports[k]);
-                if (subports[j] == NULL) {
-                    VLOG_WARN("Unable to find subport %s of port %s",
-                              intf_ptr->subports[k], intf_ptr->name);
-                } else {
-                    j++;
-                }
-                k++;
-            }
-            ovsrec_interface_set_split_children(ovs_intf[i], subports, j);
-        }
-    }
-    shash_destroy(&ovs_intf_shash);
-
-} /* sysd_set_splittable_port_info */
-
-struct ovsrec_daemon *
-sysd_initial_daemon_add(struct ovsdb_idl_txn *txn, daemon_info_t *daemon_ptr)
-{
-    struct ovsrec_daemon     *ovs_daemon = NULL;
-
-    ovs_daemon = ovsrec_daemon_insert(txn);
-
-    ovsrec_daemon_set_name(ovs_daemon, daemon_ptr->name);
-    ovsrec_daemon_set_cur_hw(ovs_daemon, daemon_ptr->cur_hw);
-    ovsrec_daemon_set_is_hw_handler(ovs_daemon, daemon_ptr->is_hw_handler);
-
-    return ovs_daemon;
-
-} /* sysd_initial_daemon_add */
-
-struct ovsrec_subsystem *
-sysd_initial_subsystem_add(struct ovsdb_idl_txn *txn, sysd_subsystem_t *subsys_ptr)
-{
-    int                         i = 0;
-    fru_eeprom_t                *fru = NULL;
-    char                        mac_addr[32];
-    char                        *tmp_p;
-
-    struct smap                 other_info;
-    struct ovsrec_subsystem     *ovs_subsys = NULL;
-    struct ovsrec_interface     **ovs_intf = NULL;
-
-    ovs_subsys = ovsrec_subsystem_insert(txn);
-
-    fru = &(subsys_ptr->fru_eeprom);
-
-    ovsrec_subsystem_set_name(ovs_subsys, subsys_ptr->name);
-    ovsrec_subsystem_set_asset_tag_number(ovs_subsys, DFLT_ASSET_TAG);
-    ovsrec_subsystem_set_hw_desc_dir(ovs_subsys, g_hw_desc_dir);
-
-    smap_init(&other_info);
-
-    smap_add(&other_info, "country_code", fru->country_code);
-    smap_add_format(&other_info, "device_version", "%c", fru->device_version);
-    smap_add(&other_info, "diag_version", fru->diag_version ? : "");
-    smap_add(&other_info, "label_revision", fru->label_revision ? : "");
-    smap_add_format(&other_info, "base_mac_address",
-                    "%02x:%02x:%02x:%02x:%02x:%02x",
-                    SYSD_MAC_FORMAT(fru->base_mac_address));
-    smap_add_format(&other_info, "number_of_macs", "%d", fru->num_macs);
-    smap_add(&other_info, "manufacturer", fru->manufacturer ? : "");
-    smap_add(&other_info, "manufacture_date", fru->manufacture_date ? : "");
-    smap_add(&other_info, "onie_version", fru->onie_version ? : "");
-    smap_add(&other_info, "part_number", fru->part_number ? : "");
-    smap_add(&other_info, "Product Name", fru->product_name ? : "");
-    smap_add(&other_info, "platform_name", fru->platform_name ? : "");
-    smap_add(&other_info, "serial_number", fru->serial_number ? : "");
-    smap_add(&other_info, "vendor", fru->vendor ? : "");
-
-    smap_add_format(&other_info, "interface_count",
-                    "%d", subsys_ptr->intf_cmn_info->number_ports);
-    smap_add_format(&other_info, "max_interface_speed",
-                    "%d", subsys_ptr->intf_cmn_info->max_port_speed);
-    smap_add_format(&other_info, "max_transmission_unit",
-                    "%d", subsys_ptr->intf_cmn_info->max_transmission_unit);
-    smap_add_format(&other_info, "max_bond_count",
-                    "%d", subsys_ptr->intf_cmn_info->max_lag_count);
-    smap_add_format(&other_info, "max_bond_member_count",
-                    "%d", subsys_ptr->intf_cmn_info->max_lag_member_count);
-    smap_add_format(&other_info, "l3_port_requires_internal_vlan",
-                    "%d", subsys_ptr->intf_cmn_info->l3_port_requires_internal_vlan);
-
-    ovsrec_subsystem_set_other_info(ovs_subsys, &other_info);
-    smap_destroy(&other_info);
-
-    ovs_intf = SYSD_OVS_PTR_CALLOC(ovsrec_interface *, subsys_ptr->intf_count);
-    if (ovs_intf == NULL) {
-        VLOG_ERR("Failed to allocate memory for OVS subsystem interfaces.");
-        log_event("SYS_ALLOCATE_MEMORY_FAILURE", EV_KV("value",
-            "%s", "OVS subsystem interfaces"));
-        return ovs_subsys;
-    }
-
-    for (i = 0; i < subsys_ptr->intf_count; i++) {
-        ovs_intf[i] = sysd_initial_interface_add(txn, subsys_ptr, subsys_ptr->interfaces[i]);
-    }
-
-    sysd_set_splittable_port_info(ovs_intf, subsys_ptr);
-
-    /* Save next_mac_address and macs_remaining in subsystem */
-    memset(mac_addr, 0, sizeof(mac_addr));
-    tmp_p = ops_ether_ulong_long_to_string(mac_addr, subsys_ptr->nxt_mac_addr);
-    ovsrec_subsystem_set_next_mac_address(ovs_subsys, tmp_p);
-    ovsrec_subsystem_set_macs_remaining(ovs_subsys, subsys_ptr->num_free_macs);
-
-    ovsrec_subsystem_set_interfaces(ovs_subsys, ovs_intf, i);
-
-    free(ovs_intf);
-
-    return ovs_subsys;
-
-} /* sysd_initial_subsystem_add */
-
-/*
- * This function is used to initialize the default bridge during system bootup.
- */
-void
-sysd_configure_default_bridge(struct ovsdb_idl_txn *txn,
-                              struct ovsrec_system *ovs_row)
-{
-    struct ovsrec_bridge *default_bridge_row = NULL;
-    struct ovsrec_port *port = NULL;
-    struct ovsrec_interface *iface = NULL;
-    struct smap hw_intf_info, user_config;
-
-    /* Create bridge */
-    default_bridge_row = ovsrec_bridge_insert(txn);
-    ovsrec_bridge_set_name(default_bridge_row, DEFAULT_BRIDGE_NAME);
-    ovsrec_system_set_bridges(ovs_row, &default_bridge_row, 1);
-
-    /*
-     * For every bridge we will create a bridge port and a bridge
-     * internal interface under it. The bridge internal interface
-     * will be used for internal interfaces such as vlan interfaces.
-     * For vlan interfaces, all vlan tagged frames for vlan interfaces
-     * will be sent up to bridge interface.
-     * bridge interface will distribute them to the appropriate vlan
-     * interfaces which will be created on top of the bridge interface.
-     */
-
-    /* Create bridge internal interface */
-    iface = ovsrec_interface_insert(txn);
-    ovsrec_interface_set_name(iface, DEFAULT_BRIDGE_NAME);
-    ovsrec_interface_set_type(iface, OVSREC_INTERFACE_TYPE_INTERNAL);
-
-    smap_init(&hw_intf_info);
-    smap_add(&hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_BRIDGE,
-             INTERFACE_HW_INTF_INFO_MAP_BRIDGE_TRUE);
-    ovsrec_interface_set_hw_intf_info(iface, &hw_intf_info);
-    smap_destroy(&hw_intf_info);
-
-    /*
-     * bridge interface is used internally. Essentially
-     * we do not expect user to configure this interface.
-     * We will set the 'admin' to up as we create it.
-     */
-    smap_init(&user_config);
-    smap_add(&user_config, INTERFACE_USER_CONFIG_MAP_ADMIN,
-             OVSREC_INTERFACE_USER_CONFIG_ADMIN_UP);
-
-    ovsrec_interface_set_user_config(iface, &user_config);
-    smap_destroy(&user_config);
-
-    /* Create port for bridge */
-    port = ovsrec_port_insert(txn);
-    ovsrec_port_set_name(port, DEFAULT_BRIDGE_NAME);
-
-    /* Add the internal interface to port */
-    ovsrec_port_set_interfaces(port, &iface, 1);
-
-    /* Add port to the bridge */
-    ovsrec_bridge_set_ports(default_bridge_row, &port, 1);
-
-}/* sysd_configure_default_bridge */
-
-/*
- * This function is used to initialize the default VRF during system bootup.
- */
-void
-sysd_configure_default_vrf(struct ovsdb_idl_txn *txn,
-                           struct ovsrec_system *ovs_row)
-{
-    struct ovsrec_vrf *default_vrf_row = NULL;
-    struct smap smap_vrf_status;
-    const int64_t table_id = 0;
-
-    default_vrf_row = ovsrec_vrf_insert(txn);
-    ovsrec_vrf_set_name(default_vrf_row, DEFAULT_VRF_NAME);
-    ovsrec_system_set_vrfs(ovs_row, &default_vrf_row, 1);
-    ovsrec_vrf_set_table_id(default_vrf_row, &table_id, sizeof(table_id));
-    smap_clone(&smap_vrf_status, &default_vrf_row->status);
-    smap_add_once(&smap_vrf_status, VRF_STATUS_KEY, VRF_STATUS_VALUE);
-
-    ovsrec_vrf_set_status(default_vrf_row, &smap_vrf_status);
-    smap_destroy(&smap_vrf_status);
-
-}/* sysd_configure_default_vrf */
+/* Set once the database has been brought in line with the h/w
+ * description, by the initial configuration or by a warm restart. */
+static bool db_reconciled = false;
 
 /*
  * Helper function to parse version_detail yaml file.
@@ -510,6 +203,7 @@ sysd_add_package_info()
                                 ovsdb_idl_txn_destroy(txn);
                                 return;
                             }
+                            COVERAGE_INC(sysd_pkg_info_row);
                             ovsrec_package_info_set_name(row,
                             (const char *)event.data.scalar.value);
                             break;
@@ -541,6 +235,7 @@ sysd_add_package_info()
                             if ((record_count % PKG_INFO_ENTRIES_PER_COMMIT)
                                 == 0) {
                                 txn_status = ovsdb_idl_txn_commit_block(txn);
+                                SYSD_TXN_COVERAGE(pkg_info, txn_status);
                                 VLOG_INFO("Populating Package_Info with"
                                           "%d entries\n", record_count);
                                 if (txn_status != TXN_SUCCESS) {
@@ -579,6 +274,7 @@ sysd_add_package_info()
 
     if (txn != NULL) {
         txn_status = ovsdb_idl_txn_commit_block(txn);
+        SYSD_TXN_COVERAGE(pkg_info, txn_status);
         VLOG_INFO("Populating Package_Info with %d entries\n", record_count);
         if (txn_status != TXN_SUCCESS) {
             VLOG_ERR("Commit failed to Package_Info. rc = %u", txn_status);
@@ -612,6 +308,8 @@ sysd_update_sw_info(const struct ovsrec_system *cfg)
     size_t line_len = 0;
     int i;
 
+    COVERAGE_INC(sysd_os_release_parse);
+
     /* Open os-release file with the os version information */
     os_ver_fp = fopen(OS_RELEASE_FILE_PATH, "r");
     if (NULL == os_ver_fp) {
@@ -709,6 +407,7 @@ sysd_handle_timezone_update(const struct ovsrec_system *cfg)
           memset(&timezone_cmd[0], 0, sizeof(timezone_cmd));
           strcpy(timezone_cmd, base_path);
           strcat(timezone_cmd, ovsdb_timezone);
+          COVERAGE_INC(sysd_timezone_apply);
           unlink("/etc/localtime");
           ret_val = symlink(timezone_cmd, "/etc/localtime");
           if (ret_val < 0) {
@@ -732,79 +431,12 @@ sysd_handle_timezone_update(const struct ovsrec_system *cfg)
 void
 sysd_initial_configure(struct ovsdb_idl_txn *txn)
 {
-    int     i = 0;
-    char    mac_addr[32];
-    char    *tmp_p;
-    struct ovsrec_daemon **ovs_daemon_l = NULL;
-    struct ovsrec_subsystem **ovs_subsys_l = NULL;
     struct ovsrec_system *sys = NULL;
-    struct smap smap = SMAP_INITIALIZER(&smap);
+    struct sysd_reconcile_stats stats;
 
     /* Add System row */
     sys = ovsrec_system_insert(txn);
 
-    /* Add the interface name to ovsdb */
-    smap_add(&smap, SYSTEM_MGMT_INTF_MAP_NAME, mgmt_intf->name);
-
-    ovsrec_system_set_mgmt_intf(sys, &smap);
-    smap_destroy(&smap);
-
-    /* Add default bridge and VRF rows */
-    sysd_configure_default_bridge(txn, sys);
-    sysd_configure_default_vrf(txn, sys);
-
-    /* Assign system wide mgmt i/f MAC address
-     * Set System:management_mac
-    */
-
-    /* OPS_TODO: Need to update for multiple subsystem
-     * for now, assume that subsystem[0] is the base subsystem and use
-     * the mgmt MAC for the base subsystem as the system wide mgmt MAC.
-    */
-
-    memset(mac_addr, 0, sizeof(mac_addr));
-    tmp_p = ops_ether_ulong_long_to_string(mac_addr, subsystems[0]->mgmt_mac_addr);
-    ovsrec_system_set_management_mac(sys, tmp_p);
-
-    /* Assign general use MAC */
-    /* OPS_TODO: Using subsystem[0] for now */
-    memset(mac_addr, 0, sizeof(mac_addr));
-    tmp_p = ops_ether_ulong_long_to_string(mac_addr, subsystems[0]->system_mac_addr);
-    ovsrec_system_set_system_mac(sys, tmp_p);
-
-    /* Add the subsystem info to OVSD */
-    ovs_subsys_l = SYSD_OVS_PTR_CALLOC(ovsrec_subsystem *, num_subsystems);
-    if (ovs_subsys_l == NULL) {
-        VLOG_ERR("Failed to allocate memory for OVS subsystem.");
-        log_event("SYS_ALLOCATE_MEMORY_FAILURE", EV_KV("value",
-            "%s", "OVS subsystem"));
-        return;
-    }
-
-    for (i = 0; i < num_subsystems; i++) {
-        ovs_subsys_l[i] = sysd_initial_subsystem_add(txn, subsystems[i]);
-    }
-
-    ovsrec_system_set_subsystems(sys, ovs_subsys_l, num_subsystems);
-
-    /* Add the daemon info to the daemon table */
-    ovs_daemon_l = SYSD_OVS_PTR_CALLOC(ovsrec_daemon *, num_daemons);
-    if (ovs_daemon_l == NULL) {
-        VLOG_ERR("Failed to allocate memory for OVS daemon table.");
-        log_event("SYS_ALLOCATE_MEMORY_FAILURE", EV_KV("value",
-            "%s", "OVS daemon table"));
-        return;
-    }
-
-    if (num_daemons > 0) {
-        for (i = 0; i < num_daemons; i++) {
-            ovs_daemon_l[i] = sysd_initial_daemon_add(txn, daemons[i]);
-        }
-
-        ovsrec_system_set_daemons(sys, ovs_daemon_l, num_daemons);
-    }
-    free(ovs_daemon_l);
-
     /*
      * Update the software info, including the switch version,
      * for the new config
@@ -812,14 +444,8 @@ sysd_initial_configure(struct ovsdb_idl_txn *txn)
     sysd_update_sw_info(sys);
     ovsrec_system_set_timezone(sys, DFLT_TIMEZONE);
 
-    /* QoS init */
-    qos_init_trust(txn, sys);
-    qos_init_dscp_map(txn, sys);
-    qos_init_cos_map(txn, sys);
-    qos_init_queue_profile(txn, sys);
-    qos_init_schedule_profile(txn, sys);
-    /* ACL init */
-    acl_init_limits(txn, sys);
+    /* Everything else is what a warm restart reconciles as well. */
+    sysd_reconcile(txn, sys, true, &stats);
 } /* sysd_initial_configure */
 
 static void
@@ -828,6 +454,7 @@ sysd_set_hw_done(void)
     struct ovsdb_idl_txn *txn = NULL;
     const struct ovsrec_system *sys = NULL;
     enum ovsdb_idl_txn_status txn_status = TXN_ERROR;
+    int64_t generation;
     char hostname[128];
     int ret;
 
@@ -838,14 +465,17 @@ sysd_set_hw_done(void)
     txn = ovsdb_idl_txn_create(idl);
 
     OVSREC_SYSTEM_FOR_EACH(sys, idl) {
-        ovsrec_system_set_cur_hw(sys, (int64_t) 1);
+        /* A restarted sysd keeps the h/w generation it finds in the db. */
+        generation = MAX(sys->next_hw, 1);
+        ovsrec_system_set_cur_hw(sys, generation);
         VLOG_INFO("%s system cur_hw after %d", hostname, (int)(sys->cur_hw));
-        ovsrec_system_set_next_hw(sys, (int64_t) 1);
+        ovsrec_system_set_next_hw(sys, generation);
     }
 
     txn_status = ovsdb_idl_txn_commit_block(txn);
+    SYSD_TXN_COVERAGE(hw_done, txn_status);
     if (txn_status != TXN_SUCCESS) {
-        VLOG_ERR("Failed to set cur_hw, next_hw = 1. rc = %u", txn_status);
+        VLOG_ERR("Failed to set cur_hw, next_hw. rc = %u", txn_status);
     }
     ovsdb_idl_txn_destroy(txn);
 
@@ -855,14 +485,227 @@ sysd_set_hw_done(void)
 
 } /* sysd_set_hw_done() */
 
+/*
+ * Advances the System h/w generation. 'rebuild' is true if a h/w daemon
+ * started re-initializing, which opens a new generation in next_hw unless
+ * one is already open. 'all_ready' is true once every h/w daemon is ready
+ * again, which completes the open generation by setting cur_hw to next_hw.
+ */
+static void
+sysd_advance_hw_generation(bool rebuild, bool all_ready)
+{
+    struct ovsdb_idl_txn *txn = NULL;
+    const struct ovsrec_system *sys = NULL;
+    enum ovsdb_idl_txn_status txn_status = TXN_ERROR;
+    int64_t next_hw, cur_hw;
+
+    sys = ovsrec_system_first(idl);
+    if (sys == NULL) {
+        return;
+    }
+
+    next_hw = sys->next_hw;
+    cur_hw = sys->cur_hw;
+
+    if (rebuild && next_hw == cur_hw) {
+        next_hw = cur_hw + 1;
+    }
+    if (all_ready) {
+        cur_hw = next_hw;
+    }
+
+    if (next_hw == sys->next_hw && cur_hw == sys->cur_hw) {
+        return;
+    }
+
+    txn = ovsdb_idl_txn_create(idl);
+    ovsrec_system_set_next_hw(sys, next_hw);
+    ovsrec_system_set_cur_hw(sys, cur_hw);
+    txn_status = ovsdb_idl_txn_commit_block(txn);
+    SYSD_TXN_COVERAGE(hw_gen, txn_status);
+    ovsdb_idl_txn_destroy(txn);
+
+    if (txn_status != TXN_SUCCESS) {
+        VLOG_ERR("Failed to set cur_hw = %"PRId64", next_hw = %"PRId64". "
+                 "rc = %s", cur_hw, next_hw,
+                 ovsdb_idl_txn_status_to_string(txn_status));
+        return;
+    }
+
+    VLOG_INFO("H/w generation cur_hw = %"PRId64", next_hw = %"PRId64,
+              cur_hw, next_hw);
+    if (cur_hw == next_hw) {
+        log_event("SYS_HW_REINIT_DONE",
+                  EV_KV("generation", "%"PRId64, cur_hw));
+    }
+
+} /* sysd_advance_hw_generation */
+
+/*
+ * Updates the System:other_info watchdog keys in 'smap'. The state is
+ * "degraded" while any h/w daemon is past its deadline and "ready" once
+ * 'all' h/w daemons are ready. Returns true if 'smap' was changed.
+ */
+static bool
+sysd_update_readiness_state(struct smap *smap, bool all)
+{
+    struct ds late = DS_EMPTY_INITIALIZER;
+    const char *state = NULL;
+    const char *old;
+    daemon_info_t *daemon;
+    bool changed = false;
+
+    SYSD_DAEMON_FOR_EACH (daemon, &daemon_registry) {
+        if (daemon->deadline_missed && !daemon->hw_ready_recorded) {
+            ds_put_format(&late, "%s%s", late.length ? "," : "",
+                          daemon->name);
+        }
+    }
+
+    if (late.length) {
+        state = SYSD_HW_READINESS_DEGRADED;
+    } else if (all) {
+        state = SYSD_HW_READINESS_READY;
+    }
+
+    old = smap_get(smap, SYSD_HW_READINESS_KEY);
+    if (state != NULL && (old == NULL || strcmp(old, state))) {
+        smap_replace(smap, SYSD_HW_READINESS_KEY, state);
+        VLOG_INFO("H/w readiness is %s", state);
+        changed = true;
+    }
+
+    old = smap_get(smap, SYSD_HW_LATE_DAEMONS_KEY);
+    if (late.length && (old == NULL || strcmp(old, ds_cstr(&late)))) {
+        smap_replace(smap, SYSD_HW_LATE_DAEMONS_KEY, ds_cstr(&late));
+        changed = true;
+    } else if (!late.length && old != NULL) {
+        smap_remove(smap, SYSD_HW_LATE_DAEMONS_KEY);
+        changed = true;
+    }
+
+    ds_destroy(&late);
+
+    return changed;
+
+} /* sysd_update_readiness_state */
+
+/*
+ * Publishes System:other_info readiness markers for every stage that has
+ * become ready since the last call, along with the time-to-ready of every
+ * newly ready h/w daemon and the watchdog state. If 'all' is true, every
+ * stage is marked ready regardless of its daemons, which is used once the
+ * system as a whole is declared h/w ready.
+ */
+static void
+sysd_publish_readiness(bool all)
+{
+    struct ovsdb_idl_txn *txn = NULL;
+    const struct ovsrec_system *sys = NULL;
+    enum ovsdb_idl_txn_status txn_status = TXN_ERROR;
+    struct smap smap = SMAP_INITIALIZER(&smap);
+    struct shash_node *node;
+    sysd_daemon_stage_t *stage;
+    daemon_info_t *daemon;
+    char key[MAX_DAEMON_NAME_LEN + sizeof(SYSD_STAGE_READY_KEY_PREFIX)
+             + sizeof(SYSD_READY_P50_KEY_PREFIX)];
+    char value[32];
+    long long int p50, p99;
+    int n_new = 0;
+
+    sys = ovsrec_system_first(idl);
+    if (sys == NULL) {
+        return;
+    }
+
+    smap_clone(&smap, &sys->other_info);
+
+    SHASH_FOR_EACH (node, &daemon_registry.stages) {
+        stage = node->data;
+        if (stage->published
+            || (!all && stage->n_ready < stage->n_daemons)) {
+            continue;
+        }
+
+        snprintf(key, sizeof(key), "%s%s", SYSD_STAGE_READY_KEY_PREFIX,
+                 stage->name);
+        smap_replace(&smap, key, "true");
+        VLOG_INFO("Readiness stage '%s' is ready", stage->name);
+        n_new++;
+    }
+
+    SYSD_DAEMON_FOR_EACH (daemon, &daemon_registry) {
+        if (!daemon->hw_ready_recorded || !daemon->seen_not_ready
+            || daemon->hw_ready_published) {
+            continue;
+        }
+
+        snprintf(key, sizeof(key), "%s%s", SYSD_READY_MSEC_KEY_PREFIX,
+                 daemon->name);
+        snprintf(value, sizeof(value), "%lld", daemon->hw_ready_msec);
+        smap_replace(&smap, key, value);
+        n_new++;
+
+        /* This boot's time has just been added to the history. */
+        if (sysd_readiness_percentiles(daemon->name, &p50, &p99)) {
+            snprintf(key, sizeof(key), "%s%s", SYSD_READY_P50_KEY_PREFIX,
+                     daemon->name);
+            snprintf(value, sizeof(value), "%lld", p50);
+            smap_replace(&smap, key, value);
+            snprintf(key, sizeof(key), "%s%s", SYSD_READY_P99_KEY_PREFIX,
+                     daemon->name);
+            snprintf(value, sizeof(value), "%lld", p99);
+            smap_replace(&smap, key, value);
+        }
+    }
+
+    if (sysd_update_readiness_state(&smap, all)) {
+        n_new++;
+    }
+
+    if (n_new == 0) {
+        smap_destroy(&smap);
+        return;
+    }
+
+    txn = ovsdb_idl_txn_create(idl);
+    ovsrec_system_set_other_info(sys, &smap);
+    txn_status = ovsdb_idl_txn_commit_block(txn);
+    SYSD_TXN_COVERAGE(readiness, txn_status);
+    ovsdb_idl_txn_destroy(txn);
+    smap_destroy(&smap);
+
+    if (txn_status != TXN_SUCCESS && txn_status != TXN_UNCHANGED) {
+        VLOG_ERR("Failed to publish h/w readiness. rc = %s",
+                 ovsdb_idl_txn_status_to_string(txn_status));
+        return;
+    }
+
+    SHASH_FOR_EACH (node, &daemon_registry.stages) {
+        stage = node->data;
+        if (all || stage->n_ready == stage->n_daemons) {
+            stage->published = true;
+        }
+    }
+
+    SYSD_DAEMON_FOR_EACH (daemon, &daemon_registry) {
+        if (daemon->hw_ready_recorded) {
+            daemon->hw_ready_published = true;
+        }
+    }
+
+} /* sysd_publish_readiness */
+
 static void
 sysd_chk_if_hw_daemons_done(void)
 {
-    int i;
-    int not_set = false;
+    int num_pending = 0;
     int num_found = 0;
+    int num_late = 0;
+    bool rebuild = false;
 
     const struct ovsrec_daemon *db_daemon;
+    daemon_info_t *daemon;
     char hostname[128];
     int ret = 0;
 
@@ -884,60 +727,149 @@ sysd_chk_if_hw_daemons_done(void)
      * The configuration daemon waits for sysd to set System:cur_hw=1
      * before it tries to push anything into the db, to ensure that all h/w
      * processing is done before any user configuration is pushed.
+     *
+     * If some h/w daemons miss their image.manifest deadline, the
+     * readiness quorum (if configured) lets System:cur_hw proceed as soon
+     * as enough of the other h/w daemons are ready. The late daemons keep
+     * being tracked afterwards until they are ready.
+     *
+     * Daemon:cur_hw is a generation. A h/w daemon that re-initializes
+     * either resets it to 0 while it rebuilds its h/w state or bumps it
+     * when done. Either way sysd opens a new System:next_hw generation
+     * and sets System:cur_hw to it once all h/w daemons are ready again.
     */
 
+    COVERAGE_INC(sysd_readiness_eval);
+
     ret = gethostname(hostname, sizeof(hostname));
     if(ret < 0)
         VLOG_ERR("hostname:%s ret errno:%s", hostname, strerror(errno));
 
-    VLOG_INFO("hostname:%s Number of Daemons running %d", hostname,
-              num_hw_daemons);
+    VLOG_DBG("hostname:%s Number of Daemons running %"PRIuSIZE, hostname,
+             daemon_registry.n_hw_daemons);
 
-    if (num_hw_daemons <= 0) {
+    if (daemon_registry.n_hw_daemons == 0) {
+        sysd_publish_readiness(true);
         sysd_set_hw_done();
         return;
     }
 
+    /* Match Daemon rows to manifest entries once per IDL change, rather
+     * than scanning the Daemon table for every h/w daemon. */
+    sysd_daemon_registry_bind_rows(&daemon_registry, idl);
+    sysd_readiness_record(&daemon_registry);
+
+    /* Stages only wait for their own daemons and dependencies, so
+     * consumers of an early stage need not wait for System:cur_hw. */
+    sysd_daemon_registry_eval_ready(&daemon_registry);
+
     /* See if all h/w daemons have set cur_hw > 0 */
-    for (i = 0; i < num_daemons; i++) {
-        if (daemons[i]->is_hw_handler) {
-            OVSREC_DAEMON_FOR_EACH(db_daemon, idl) {
-                VLOG_INFO("%s db_daemon:'%s' daemons_manifest:'%s'"
-                           " db_daemon cur_hw: %d db_daemon is_hw_handler: %d",
-                           hostname, db_daemon->name, daemons[i]->name,
-                           (int)(db_daemon->cur_hw),
-                           (int)(db_daemon->is_hw_handler));
-                if (db_daemon->is_hw_handler) {
-                    if (strncmp(daemons[i]->name, db_daemon->name,
-                                strlen(daemons[i]->name)) == 0) {
-                        if (db_daemon->cur_hw > 0) {
-                            num_found++;
-                        } else {
-                            not_set = true;
-                        }
-                        break;
-                    }
-                }
+    SYSD_DAEMON_FOR_EACH (daemon, &daemon_registry) {
+        db_daemon = daemon->row;
+        if (!daemon->is_hw_handler || db_daemon == NULL
+            || !db_daemon->is_hw_handler) {
+            continue;
+        }
+
+        VLOG_DBG("%s db_daemon:'%s' db_daemon cur_hw: %d",
+                 hostname, db_daemon->name, (int)(db_daemon->cur_hw));
+
+        if (db_daemon->cur_hw > 0) {
+            num_found++;
+        } else {
+            num_pending++;
+            /* Only daemons that have never been ready are late; one that
+             * made it after its deadline and then re-initializes must be
+             * waited for like any other. */
+            if (daemon->deadline_missed && !daemon->hw_ready_recorded) {
+                num_late++;
             }
         }
-        if (not_set) {
-            break;
+
+        if (hw_init_done_set && daemon->cur_hw > 0
+            && (db_daemon->cur_hw <= 0 || db_daemon->cur_hw > daemon->cur_hw)) {
+            VLOG_INFO("%s daemon '%s' re-initializing h/w, generation "
+                      "%"PRId64" -> %"PRId64, hostname, daemon->name,
+                      daemon->cur_hw, db_daemon->cur_hw);
+            rebuild = true;
         }
+        daemon->cur_hw = db_daemon->cur_hw;
     }
 
-    /* Not all set, try again later. */
-    if (not_set || (num_found == 0))
+    if (hw_init_done_set) {
+        /* Track late daemons and h/w re-initializations. Daemons that
+         * never made it at boot do not hold back later generations. */
+        sysd_publish_readiness(true);
+        sysd_advance_hw_generation(rebuild, num_pending == num_late);
         return;
-    else
+    }
+
+    if (num_found > 0 && num_pending == 0) {
         VLOG_INFO("%s num_found count %d", hostname, num_found);
+    } else if (num_pending > 0 && num_pending == num_late
+               && daemon_registry.quorum > 0
+               && num_found >= (int) daemon_registry.quorum) {
+        VLOG_WARN("%s %d h/w daemons missed their deadline, proceeding "
+                  "with a quorum of %d", hostname, num_late, num_found);
+        log_event("SYS_HW_READY_QUORUM",
+                  EV_KV("late", "%d", num_late),
+                  EV_KV("ready", "%d", num_found));
+    } else {
+        /* Not all set, try again later. */
+        sysd_publish_readiness(false);
+        return;
+    }
 
     /* All are set. Now set system table cur_hw, next_hw = 1 */
+    sysd_publish_readiness(true);
     sysd_set_hw_done();
 
     return;
 
 } /* sysd_chk_if_hw_daemons_done() */
 
+/*
+ * Brings the database sysd finds on a restart in line with the h/w
+ * description files and the image.manifest file, writing only what
+ * differs.
+ */
+static void
+sysd_warm_reconcile(const struct ovsrec_system *cfg)
+{
+    enum ovsdb_idl_txn_status           txn_status = TXN_ERROR;
+    struct ovsdb_idl_txn                *txn = NULL;
+    struct sysd_reconcile_stats         stats;
+
+    /* The h/w description files may have been released by an earlier
+     * attempt. */
+    if (sysd_get_interface_info()) {
+        VLOG_ERR("Unable to reload interfaces for the reconciliation.");
+        return;
+    }
+
+    txn = ovsdb_idl_txn_create(idl);
+
+    sysd_reconcile(txn, CONST_CAST(struct ovsrec_system *, cfg), false,
+                   &stats);
+
+    txn_status = ovsdb_idl_txn_commit_block(txn);
+    SYSD_TXN_COVERAGE(reconcile, txn_status);
+    ovsdb_idl_txn_destroy(txn);
+
+    if (txn_status != TXN_SUCCESS && txn_status != TXN_UNCHANGED) {
+        VLOG_ERR("Failed to commit the reconciliation. rc = %s",
+                 ovsdb_idl_txn_status_to_string(txn_status));
+        return;
+    }
+
+    VLOG_INFO("Reconciled the database: %"PRIuSIZE" rows inserted, "
+              "%"PRIuSIZE" columns updated, %"PRIuSIZE" rows removed",
+              stats.n_inserted, stats.n_updated, stats.n_removed);
+    db_reconciled = true;
+    sysd_release_interface_info();
+
+} /* sysd_warm_reconcile */
+
 void
 sysd_run(void)
 {
@@ -945,6 +877,8 @@ sysd_run(void)
     enum ovsdb_idl_txn_status           txn_status = TXN_ERROR;
     struct ovsdb_idl_txn                *txn = NULL;
     const struct ovsrec_system    *cfg = NULL;
+
+    COVERAGE_INC(sysd_run);
     ovsdb_idl_run(idl);
 
     if (ovsdb_idl_is_lock_contended(idl)) {
@@ -961,26 +895,48 @@ sysd_run(void)
 
     new_seqno = ovsdb_idl_get_seqno(idl);
     if (new_seqno != idl_seqno) {
+        COVERAGE_INC(sysd_seqno_changed);
+        sysd_loop_note_wake(SYSD_WAKE_DB);
 
         idl_seqno = ovsdb_idl_get_seqno(idl);
 
         cfg = ovsrec_system_first(idl);
 
         if (cfg == NULL) {
+            /* The h/w description files are released after a successful
+             * initial configuration, so reload them for a retry. */
+            if (sysd_get_interface_info()) {
+                VLOG_ERR("Unable to reload interfaces for the initial "
+                         "configuration.");
+                return;
+            }
+
             txn = ovsdb_idl_txn_create(idl);
 
             sysd_initial_configure(txn);
 
             txn_status = ovsdb_idl_txn_commit_block(txn);
+            SYSD_TXN_COVERAGE(initial, txn_status);
             if (txn_status != TXN_SUCCESS) {
                 VLOG_ERR("Failed to commit the transaction. rc = %s", ovsdb_idl_txn_status_to_string(txn_status));
             }
             ovsdb_idl_txn_destroy(txn);
+
+            if (txn_status == TXN_SUCCESS) {
+                db_reconciled = true;
+                sysd_release_interface_info();
+            }
         } else {
-            /* Update the software information. */
-            sysd_update_sw_info(cfg);
+            if (!db_reconciled) {
+                /* sysd restarted on a populated database. */
+                sysd_warm_reconcile(cfg);
+                cfg = ovsrec_system_first(idl);
+            }
+
+            if (cfg != NULL) {
+                /* Update the software information. */
+                sysd_update_sw_info(cfg);
 
-            if (!hw_init_done_set) {
                 sysd_chk_if_hw_daemons_done();
             }
         }
@@ -992,53 +948,585 @@ sysd_run(void)
         sysd_handle_timezone_update(cfg);
     }
 
+    /* A daemon deadline passing is not an IDL change, so the watchdog is
+     * checked on every wakeup. */
+    if (!hw_init_done_set && ovsrec_system_first(idl) != NULL
+        && sysd_readiness_watchdog_run(&daemon_registry)) {
+        sysd_loop_note_wake(SYSD_WAKE_TIMER);
+        sysd_chk_if_hw_daemons_done();
+    }
+
     /* Notify parent of startup completion. */
     daemonize_complete();
 
 } /* sysd_run */
 
+static const char *
+sysd_dump_str(const char *str)
+{
+    return (str != NULL && str[0] != '\0') ? str : "-";
+} /* sysd_dump_str */
+
+static void
+sysd_dump_daemons(struct ds *ds)
+{
+    daemon_info_t *daemon;
+
+    ds_put_format(ds, "%-24s %-14s %-8s %s\n",
+                  "Name", "is_hw_handler", "cur_hw", "stage");
+
+    SYSD_DAEMON_FOR_EACH (daemon, &daemon_registry) {
+        ds_put_format(ds, "%-24s %-14d %-8"PRId64" %s\n",
+                      daemon->name, daemon->is_hw_handler, daemon->cur_hw,
+                      daemon->stage ? daemon->stage->name : "-");
+    }
+} /* sysd_dump_daemons */
+
+static void
+sysd_dump_mgmt_intf(struct ds *ds)
+{
+    ds_put_format(ds, "%s\n", mgmt_intf ? mgmt_intf->name : "-");
+} /* sysd_dump_mgmt_intf */
+
+static void
+sysd_dump_subsystems(struct ds *ds)
+{
+    const sysd_intf_cmn_info_t  *cmn;
+    int                         i;
+
+    for (i = 0; i < num_subsystems; i++) {
+        ds_put_format(ds, "%s: type %s, %s, %d interfaces\n",
+                      subsystems[i]->name, sysd_dump_str(subsystems[i]->type),
+                      subsystems[i]->valid ? "valid" : "invalid",
+                      subsystems[i]->intf_count);
+
+        cmn = subsystems[i]->intf_cmn_info;
+        if (cmn != NULL) {
+            ds_put_format(ds, "    number_ports %d, max_port_speed %d, "
+                          "max_transmission_unit %d\n",
+                          cmn->number_ports, cmn->max_port_speed,
+                          cmn->max_transmission_unit);
+            ds_put_format(ds, "    max_lag_count %d, max_lag_member_count %d, "
+                          "l3_port_requires_internal_vlan %d\n",
+                          cmn->max_lag_count, cmn->max_lag_member_count,
+                          cmn->l3_port_requires_internal_vlan);
+        }
+    }
+} /* sysd_dump_subsystems */
+
+static void
+sysd_dump_interfaces(struct ds *ds)
+{
+    const sysd_port_summary_t   *port;
+    int                         i, j;
+
+    ds_put_format(ds, "%-12s %-10s %-9s %-10s %9s %6s %6s %s\n",
+                  "Subsystem", "Name", "Pluggable", "Connector",
+                  "Max speed", "Device", "Port", "Parent");
+
+    for (i = 0; i < num_subsystems; i++) {
+        if (subsystems[i]->ports == NULL) {
+            continue;
+        }
+        for (j = 0; j < subsystems[i]->intf_count; j++) {
+            port = &subsystems[i]->ports[j];
+            ds_put_format(ds, "%-12s %-10s %-9s %-10s %9d %6d %6d %s\n",
+                          subsystems[i]->name, sysd_dump_str(port->name),
+                          port->pluggable ? "yes" : "no",
+                          sysd_dump_str(port->connector), port->max_speed,
+                          port->device, port->device_port,
+                          sysd_dump_str(port->parent_port));
+        }
+    }
+} /* sysd_dump_interfaces */
+
+static void
+sysd_dump_mac_pool(struct ds *ds)
+{
+    const sysd_subsystem_t  *subsys;
+    char                    mac[32];
+    int                     i;
+
+    for (i = 0; i < num_subsystems; i++) {
+        subsys = subsystems[i];
+
+        ds_put_format(ds, "%s:\n", subsys->name);
+        ds_put_format(ds, "    base MAC     %02x:%02x:%02x:%02x:%02x:%02x, "
+                      "%u addresses\n",
+                      SYSD_MAC_FORMAT(subsys->fru_eeprom.base_mac_address),
+                      subsys->fru_eeprom.num_macs);
+        ds_put_format(ds, "    system MAC   %s\n", subsys->system_mac_addr
+                      ? ops_ether_ulong_long_to_string(mac,
+                                                       subsys->system_mac_addr)
+                      : "-");
+        ds_put_format(ds, "    mgmt MAC     %s\n", subsys->mgmt_mac_addr
+                      ? ops_ether_ulong_long_to_string(mac,
+                                                       subsys->mgmt_mac_addr)
+                      : "-");
+        ds_put_format(ds, "    next free    %s, %d free\n",
+                      subsys->num_free_macs > 0
+                      ? ops_ether_ulong_long_to_string(mac,
+                                                       subsys->nxt_mac_addr)
+                      : "-",
+                      subsys->num_free_macs);
+    }
+} /* sysd_dump_mac_pool */
+
+static void
+sysd_dump_fru(struct ds *ds)
+{
+    const fru_eeprom_t  *fru;
+    int                 i;
+
+    for (i = 0; i < num_subsystems; i++) {
+        fru = &subsystems[i]->fru_eeprom;
+
+        ds_put_format(ds, "%s:\n", subsystems[i]->name);
+        ds_put_format(ds, "    product_name     %s\n",
+                      sysd_dump_str(fru->product_name));
+        ds_put_format(ds, "    part_number      %s\n",
+                      sysd_dump_str(fru->part_number));
+        ds_put_format(ds, "    serial_number    %s\n",
+                      sysd_dump_str(fru->serial_number));
+        ds_put_format(ds, "    manufacturer     %s\n",
+                      sysd_dump_str(fru->manufacturer));
+        ds_put_format(ds, "    vendor           %s\n",
+                      sysd_dump_str(fru->vendor));
+        ds_put_format(ds, "    platform_name    %s\n",
+                      sysd_dump_str(fru->platform_name));
+        ds_put_format(ds, "    manufacture_date %s\n",
+                      sysd_dump_str(fru->manufacture_date));
+        ds_put_format(ds, "    onie_version     %s\n",
+                      sysd_dump_str(fru->onie_version));
+        ds_put_format(ds, "    device_version   %d\n", fru->device_version);
+    }
+} /* sysd_dump_fru */
+
+static void
+sysd_dump_boot_timings(struct ds *ds)
+{
+    sysd_readiness_dump(ds, &daemon_registry);
+} /* sysd_dump_boot_timings */
+
+/* JSON equivalents of the sections above, for "ops-sysd/dump --json". */
+
+static struct json *
+sysd_json_string(const char *str)
+{
+    return (str != NULL && str[0] != '\0') ? json_string_create(str)
+                                           : json_null_create();
+} /* sysd_json_string */
+
+static struct json *
+sysd_json_mac(uint64_t mac)
+{
+    char buf[32];
+
+    return mac ? json_string_create(ops_ether_ulong_long_to_string(buf, mac))
+               : json_null_create();
+} /* sysd_json_mac */
+
+static struct json *
+sysd_dump_daemons_json(void)
+{
+    daemon_info_t   *daemon;
+    struct json     *array, *entry;
+
+    array = json_array_create_empty();
+    SYSD_DAEMON_FOR_EACH (daemon, &daemon_registry) {
+        entry = json_object_create();
+        json_object_put_string(entry, "name", daemon->name);
+        json_object_put(entry, "is_hw_handler",
+                        json_boolean_create(daemon->is_hw_handler));
+        json_object_put(entry, "cur_hw", json_integer_create(daemon->cur_hw));
+        json_object_put(entry, "stage",
+                        sysd_json_string(daemon->stage
+                                         ? daemon->stage->name : NULL));
+        json_object_put(entry, "ready", json_boolean_create(daemon->ready));
+        json_array_add(array, entry);
+    }
+
+    return array;
+
+} /* sysd_dump_daemons_json */
+
+static struct json *
+sysd_dump_mgmt_intf_json(void)
+{
+    return sysd_json_string(mgmt_intf ? mgmt_intf->name : NULL);
+} /* sysd_dump_mgmt_intf_json */
+
+static struct json *
+sysd_dump_subsystems_json(void)
+{
+    const sysd_intf_cmn_info_t  *cmn;
+    struct json                 *array, *entry;
+    int                         i;
+
+    array = json_array_create_empty();
+    for (i = 0; i < num_subsystems; i++) {
+        entry = json_object_create();
+        json_object_put_string(entry, "name", subsystems[i]->name);
+        json_object_put(entry, "type", sysd_json_string(subsystems[i]->type));
+        json_object_put(entry, "valid",
+                        json_boolean_create(subsystems[i]->valid));
+        json_object_put(entry, "intf_count",
+                        json_integer_create(subsystems[i]->intf_count));
+
+        cmn = subsystems[i]->intf_cmn_info;
+        if (cmn != NULL) {
+            json_object_put(entry, "number_ports",
+                            json_integer_create(cmn->number_ports));
+            json_object_put(entry, "max_port_speed",
+                            json_integer_create(cmn->max_port_speed));
+            json_object_put(entry, "max_transmission_unit",
+                            json_integer_create(cmn->max_transmission_unit));
+            json_object_put(entry, "max_lag_count",
+                            json_integer_create(cmn->max_lag_count));
+            json_object_put(entry, "max_lag_member_count",
+                            json_integer_create(cmn->max_lag_member_count));
+            json_object_put(entry, "l3_port_requires_internal_vlan",
+                            json_boolean_create(
+                                cmn->l3_port_requires_internal_vlan));
+        }
+        json_array_add(array, entry);
+    }
+
+    return array;
+
+} /* sysd_dump_subsystems_json */
+
+static struct json *
+sysd_dump_interfaces_json(void)
+{
+    const sysd_port_summary_t   *port;
+    struct json                 *array, *entry;
+    int                         i, j;
+
+    array = json_array_create_empty();
+    for (i = 0; i < num_subsystems; i++) {
+        if (subsystems[i]->ports == NULL) {
+            continue;
+        }
+        for (j = 0; j < subsystems[i]->intf_count; j++) {
+            port = &subsystems[i]->ports[j];
+            entry = json_object_create();
+            json_object_put_string(entry, "subsystem", subsystems[i]->name);
+            json_object_put(entry, "name", sysd_json_string(port->name));
+            json_object_put(entry, "pluggable",
+                            json_boolean_create(port->pluggable));
+            json_object_put(entry, "connector",
+                            sysd_json_string(port->connector));
+            json_object_put(entry, "max_speed",
+                            json_integer_create(port->max_speed));
+            json_object_put(entry, "device",
+                            json_integer_create(port->device));
+            json_object_put(entry, "device_port",
+                            json_integer_create(port->device_port));
+            json_object_put(entry, "parent_port",
+                            sysd_json_string(port->parent_port));
+            json_array_add(array, entry);
+        }
+    }
+
+    return array;
+
+} /* sysd_dump_interfaces_json */
+
+static struct json *
+sysd_dump_mac_pool_json(void)
+{
+    const sysd_subsystem_t  *subsys;
+    struct json             *array, *entry;
+    char                    mac[32];
+    int                     i;
+
+    array = json_array_create_empty();
+    for (i = 0; i < num_subsystems; i++) {
+        subsys = subsystems[i];
+
+        snprintf(mac, sizeof mac, "%02x:%02x:%02x:%02x:%02x:%02x",
+                 SYSD_MAC_FORMAT(subsys->fru_eeprom.base_mac_address));
+
+        entry = json_object_create();
+        json_object_put_string(entry, "subsystem", subsys->name);
+        json_object_put_string(entry, "base_mac", mac);
+        json_object_put(entry, "num_macs",
+                        json_integer_create(subsys->fru_eeprom.num_macs));
+        json_object_put(entry, "system_mac",
+                        sysd_json_mac(subsys->system_mac_addr));
+        json_object_put(entry, "mgmt_mac",
+                        sysd_json_mac(subsys->mgmt_mac_addr));
+        json_object_put(entry, "next_free_mac",
+                        subsys->num_free_macs > 0
+                        ? sysd_json_mac(subsys->nxt_mac_addr)
+                        : json_null_create());
+        json_object_put(entry, "num_free_macs",
+                        json_integer_create(subsys->num_free_macs));
+        json_array_add(array, entry);
+    }
+
+    return array;
+
+} /* sysd_dump_mac_pool_json */
+
+static struct json *
+sysd_dump_fru_json(void)
+{
+    const fru_eeprom_t  *fru;
+    struct json         *array, *entry;
+    int                 i;
+
+    array = json_array_create_empty();
+    for (i = 0; i < num_subsystems; i++) {
+        fru = &subsystems[i]->fru_eeprom;
+
+        entry = json_object_create();
+        json_object_put_string(entry, "subsystem", subsystems[i]->name);
+        json_object_put(entry, "product_name",
+                        sysd_json_string(fru->product_name));
+        json_object_put(entry, "part_number",
+                        sysd_json_string(fru->part_number));
+        json_object_put(entry, "serial_number",
+                        sysd_json_string(fru->serial_number));
+        json_object_put(entry, "manufacturer",
+                        sysd_json_string(fru->manufacturer));
+        json_object_put(entry, "vendor", sysd_json_string(fru->vendor));
+        json_object_put(entry, "platform_name",
+                        sysd_json_string(fru->platform_name));
+        json_object_put(entry, "manufacture_date",
+                        sysd_json_string(fru->manufacture_date));
+        json_object_put(entry, "onie_version",
+                        sysd_json_string(fru->onie_version));
+        json_object_put(entry, "device_version",
+                        json_integer_create(fru->device_version));
+        json_array_add(array, entry);
+    }
+
+    return array;
+
+} /* sysd_dump_fru_json */
+
+static struct json *
+sysd_dump_boot_timings_json(void)
+{
+    return sysd_readiness_to_json(&daemon_registry);
+} /* sysd_dump_boot_timings_json */
+
+static const struct sysd_dump_section {
+    const char  *name;
+    const char  *title;
+    void        (*dump)(struct ds *);
+    struct json *(*to_json)(void);
+} sysd_dump_sections[] = {
+    { "daemons",        "Daemon Info",      sysd_dump_daemons,
+      sysd_dump_daemons_json },
+    { "mgmt-intf",      "Mgmt_intf Info",   sysd_dump_mgmt_intf,
+      sysd_dump_mgmt_intf_json },
+    { "subsystems",     "Subsystem Info",   sysd_dump_subsystems,
+      sysd_dump_subsystems_json },
+    { "interfaces",     "Interface Info",   sysd_dump_interfaces,
+      sysd_dump_interfaces_json },
+    { "mac-pool",       "MAC Pool",         sysd_dump_mac_pool,
+      sysd_dump_mac_pool_json },
+    { "fru",            "FRU Summary",      sysd_dump_fru,
+      sysd_dump_fru_json },
+    { "boot-timings",   "Boot Timings",     sysd_dump_boot_timings,
+      sysd_dump_boot_timings_json },
+};
+
+static const struct sysd_dump_section *
+sysd_dump_find_section(const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < ARRAY_SIZE(sysd_dump_sections); i++) {
+        if (!strcmp(sysd_dump_sections[i].name, name)) {
+            return &sysd_dump_sections[i];
+        }
+    }
+    return NULL;
+} /* sysd_dump_find_section */
+
 /*
  * Function       : sysd_dump
- * Responsibility : populates buffer for unixctl reply
- * Parameters     : buffer, buffer length
- * Returns        : void
+ * Responsibility : appends the sysd debug data to 'ds', as text or as a
+ *                  JSON object with one member per section
+ * Parameters     : ds, json, names of the sections to dump (all when
+ *                  'n_sections' is 0)
+ * Returns        : NULL on success, otherwise a malloc'd error message
+ *                  naming the unknown section; 'ds' is left untouched
  */
 
+char *
+sysd_dump(struct ds *ds, bool json, int n_sections, const char *sections[])
+{
+    const struct sysd_dump_section *section;
+    struct json *object = NULL;
+    struct ds   error;
+    size_t      i;
+    int         n;
+
+    for (n = 0; n < n_sections; n++) {
+        if (sysd_dump_find_section(sections[n]) == NULL) {
+            ds_init(&error);
+            ds_put_format(&error, "unknown section \"%s\"; valid sections "
+                          "are:", sections[n]);
+            for (i = 0; i < ARRAY_SIZE(sysd_dump_sections); i++) {
+                ds_put_format(&error, " %s", sysd_dump_sections[i].name);
+            }
+            return ds_steal_cstr(&error);
+        }
+    }
+
+    if (json) {
+        object = json_object_create();
+    }
+
+    for (i = 0; i < ARRAY_SIZE(sysd_dump_sections); i++) {
+        section = &sysd_dump_sections[i];
+
+        if (n_sections > 0) {
+            for (n = 0; n < n_sections; n++) {
+                if (!strcmp(sections[n], section->name)) {
+                    break;
+                }
+            }
+            if (n == n_sections) {
+                continue;
+            }
+        }
+
+        if (json) {
+            json_object_put(object, section->name, section->to_json());
+            continue;
+        }
+
+        ds_put_format(ds, "=============== %s ===============\n",
+                      section->title);
+        section->dump(ds);
+        ds_put_cstr(ds, "\n");
+    }
+
+    if (json) {
+        json_to_ds(object, JSSF_SORT, ds);
+        ds_put_cstr(ds, "\n");
+        json_destroy(object);
+    }
+
+    return NULL;
+
+} /* sysd_dump */
+
+static size_t
+sysd_strlen(const char *str)
+{
+    return str ? strlen(str) + 1 : 0;
+} /* sysd_strlen */
+
+static size_t
+sysd_port_bytes(const sysd_intf_info_t *intf)
+{
+    size_t  bytes = sizeof *intf;
+    char    **cap_p;
+    int     k;
+
+    bytes += sysd_strlen(intf->name) + sysd_strlen(intf->connector)
+             + sysd_strlen(intf->parent_port);
+    for (cap_p = intf->capabilities; cap_p && *cap_p; cap_p++) {
+        bytes += sizeof *cap_p + sysd_strlen(*cap_p);
+    }
+    for (k = 0; k < SYSD_MAX_SPLIT_PORTS; k++) {
+        bytes += sysd_strlen(intf->subports[k]);
+    }
+
+    return bytes;
+
+} /* sysd_port_bytes */
+
+/* IDL tables sysd replicates, for the per table row counts. */
+static const struct {
+    const char                          *name;
+    const struct ovsdb_idl_table_class  *table;
+} sysd_idl_tables[] = {
+    { "idl_system",         &ovsrec_table_system },
+    { "idl_subsystem",      &ovsrec_table_subsystem },
+    { "idl_interface",      &ovsrec_table_interface },
+    { "idl_daemon",         &ovsrec_table_daemon },
+    { "idl_package_info",   &ovsrec_table_package_info },
+};
+
+/*
+ * Adds the size of sysd's long lived data to 'usage' for memory/show:
+ * the subsystem arenas, and within them the port summary and the FRU
+ * strings, the boot arena, the parsed port table while the h/w
+ * description files are loaded, the daemon registry and the IDL rows of
+ * every replicated table. The config-yaml handle is opaque and is not
+ * included.
+ */
 void
-sysd_dump(char* buf, int buflen)
+sysd_get_memory_usage(struct simap *usage)
 {
-    char tmp_buf[100];
-    int i = 0;
-
-    /* Loop through all daemons */
-
-    strcpy(buf, "=============== Daemon Info =========================\n");
-    strncat(buf, "Name\t\t\tis_hw_handler\t\t\tcur_hw\n", REM_BUF_LEN);
-
-    while((num_hw_daemons - 1) >= i) {
-        strncat(buf, daemons[i]->name, REM_BUF_LEN);
-        strncat(buf, "\t\t\t", REM_BUF_LEN);
-        sprintf(tmp_buf, "%d", daemons[i]->is_hw_handler);
-        strncat(buf, tmp_buf, REM_BUF_LEN);
-        strncat(buf, "\t\t\t", REM_BUF_LEN);
-        strcpy(tmp_buf, "\0");
-        sprintf(tmp_buf, "%ld", daemons[i]->cur_hw);
-        strncat(buf, tmp_buf, REM_BUF_LEN);
-        strncat(buf, "\n", REM_BUF_LEN);
-        i++;
+    const struct ovsdb_idl_row  *row;
+    const sysd_subsystem_t      *subsys;
+    size_t  n_ports = 0, port_bytes = 0;
+    size_t  subsys_bytes = 0, fru_bytes = 0;
+    size_t  n_rows;
+    bool    hw_desc_loaded = false;
+    size_t  t;
+    int     i, j;
+
+    for (i = 0; i < num_subsystems; i++) {
+        subsys = subsystems[i];
+        subsys_bytes += subsys->arena.allocated;
+        port_bytes += subsys->port_bytes;
+        fru_bytes += subsys->fru_bytes;
+
+        if (subsys->ports != NULL) {
+            n_ports += subsys->intf_count;
+        }
+
+        /* Only while the h/w description files are loaded. */
+        if (subsys->interfaces != NULL) {
+            hw_desc_loaded = true;
+            port_bytes += subsys->intf_count * sizeof *subsys->interfaces;
+            for (j = 0; j < subsys->intf_count; j++) {
+                if (subsys->interfaces[j] != NULL) {
+                    port_bytes += sysd_port_bytes(subsys->interfaces[j]);
+                }
+            }
+        }
     }
 
-    /* mgmt_intf */
-    strncat(buf, "=============== Mgmt_intf Info ==========================\n",
-            REM_BUF_LEN);
-    strncat(buf, mgmt_intf->name, REM_BUF_LEN);
-    strncat(buf, "\n", REM_BUF_LEN);
-}
+    simap_increase(usage, "subsystems", num_subsystems);
+    simap_increase(usage, "subsystem_bytes", subsys_bytes);
+    simap_increase(usage, "ports", n_ports);
+    simap_increase(usage, "port_bytes", port_bytes);
+    simap_increase(usage, "fru_bytes", fru_bytes);
+    simap_increase(usage, "boot_bytes", sysd_boot_arena.allocated);
+    simap_increase(usage, "hw_desc_loaded", hw_desc_loaded);
+
+    sysd_daemon_registry_get_memory_usage(&daemon_registry, usage);
+
+    for (t = 0; t < ARRAY_SIZE(sysd_idl_tables); t++) {
+        n_rows = 0;
+        for (row = ovsdb_idl_first_row(idl, sysd_idl_tables[t].table);
+             row != NULL; row = ovsdb_idl_next_row(row)) {
+            n_rows++;
+        }
+        simap_increase(usage, sysd_idl_tables[t].name, n_rows);
+    }
+
+} /* sysd_get_memory_usage */
 
 void
 sysd_wait(void)
 {
     ovsdb_idl_wait(idl);
 
+    if (!hw_init_done_set) {
+        sysd_readiness_watchdog_wait(&daemon_registry);
+    }
+
 } /* sysd_wait */
 /** @} end of group sysd */
@@ -0,0 +1,441 @@
+/************************************************************************//**
+ * (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *    License for the specific language governing permissions and limitations
+ *    under the License.
+ *
+ ***************************************************************************/
+/* @ingroup sysd
+ *
+ * @file
+ * Source for sysd h/w daemon readiness tracking.
+ *
+ * sysd timestamps the moment each h/w daemon sets Daemon:cur_hw, relative
+ * to sysd start. The last SYSD_READINESS_HISTORY_LEN times of every daemon
+ * are kept in a small ring file so that the p50/p99 time-to-ready can be
+ * reported across reboots.
+ *
+ * The readiness watchdog gives each h/w daemon a deadline, also relative
+ * to sysd start. Deadlines are driven by poll-loop timers, so a daemon
+ * that never sets cur_hw is noticed even when nothing else changes in
+ * the database.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#include <util.h>
+#include <shash.h>
+#include <dynamic-string.h>
+#include <json.h>
+#include <timeval.h>
+#include <poll-loop.h>
+#include <ovsdb-idl.h>
+#include <vswitch-idl.h>
+#include <openvswitch/vlog.h>
+
+#include "sysd_util.h"
+#include "sysd_readiness.h"
+#include "eventlog.h"
+
+VLOG_DEFINE_THIS_MODULE(sysd_readiness);
+
+/** @ingroup sysd
+ * @{ */
+
+struct sysd_ready_history {
+    long long int   samples[SYSD_READINESS_HISTORY_LEN];
+    size_t          n;      /* Number of valid samples. */
+    size_t          next;   /* Slot for the next sample. */
+};
+
+/* Time-to-ready history by daemon name. */
+static struct shash history = SHASH_INITIALIZER(&history);
+static long long int sysd_start_msec;
+
+static struct sysd_ready_history *
+sysd_history_get(const char *name)
+{
+    struct sysd_ready_history *h;
+
+    h = shash_find_data(&history, name);
+    if (h == NULL) {
+        h = xzalloc(sizeof *h);
+        shash_add(&history, name, h);
+    }
+
+    return h;
+
+} /* sysd_history_get */
+
+static void
+sysd_history_push(struct sysd_ready_history *h, long long int msec)
+{
+    h->samples[h->next] = msec;
+    h->next = (h->next + 1) % SYSD_READINESS_HISTORY_LEN;
+    if (h->n < SYSD_READINESS_HISTORY_LEN) {
+        h->n++;
+    }
+
+} /* sysd_history_push */
+
+static int
+sysd_msec_cmp(const void *a_, const void *b_)
+{
+    const long long int *a = a_;
+    const long long int *b = b_;
+
+    return *a < *b ? -1 : *a > *b;
+
+} /* sysd_msec_cmp */
+
+/* Returns the 'pct' percentile of the samples in 'h', which must not be
+ * empty, by nearest rank: the smallest sample that is at least 'pct'
+ * percent of the samples, so p99 of up to 100 samples is the slowest one.
+ * The main loop statistics use the same definition. */
+static long long int
+sysd_history_percentile(const struct sysd_ready_history *h, int pct)
+{
+    long long int   sorted[SYSD_READINESS_HISTORY_LEN];
+
+    memcpy(sorted, h->samples, h->n * sizeof sorted[0]);
+    qsort(sorted, h->n, sizeof sorted[0], sysd_msec_cmp);
+
+    return sorted[DIV_ROUND_UP(h->n * pct, 100) - 1];
+
+} /* sysd_history_percentile */
+
+/* Each line of the history file holds a daemon name followed by its
+ * time-to-ready samples in milliseconds, oldest first. */
+static void
+sysd_history_load(void)
+{
+    struct ds   line = DS_EMPTY_INITIALIZER;
+    FILE        *fp;
+    char        *save_ptr = NULL;
+    char        *name;
+    char        *token;
+    struct sysd_ready_history *h;
+
+    fp = fopen(SYSD_READINESS_FILE_PATH, "r");
+    if (fp == NULL) {
+        if (errno != ENOENT) {
+            VLOG_WARN("Unable to open %s. Error %s",
+                      SYSD_READINESS_FILE_PATH, ovs_strerror(errno));
+        }
+        return;
+    }
+
+    while (!ds_get_line(&line, fp)) {
+        name = strtok_r(ds_cstr(&line), " ", &save_ptr);
+        if (name == NULL) {
+            continue;
+        }
+
+        h = sysd_history_get(name);
+        while ((token = strtok_r(NULL, " ", &save_ptr)) != NULL) {
+            sysd_history_push(h, strtoll(token, NULL, 10));
+        }
+    }
+
+    ds_destroy(&line);
+    fclose(fp);
+
+} /* sysd_history_load */
+
+static void
+sysd_history_save(void)
+{
+    struct ds           ds = DS_EMPTY_INITIALIZER;
+    struct shash_node   *node;
+    struct sysd_ready_history *h;
+    size_t              i;
+
+    SHASH_FOR_EACH (node, &history) {
+        h = node->data;
+        ds_put_cstr(&ds, node->name);
+        for (i = 0; i < h->n; i++) {
+            ds_put_format(&ds, " %lld",
+                          h->samples[(h->next + SYSD_READINESS_HISTORY_LEN
+                                      - h->n + i)
+                                     % SYSD_READINESS_HISTORY_LEN]);
+        }
+        ds_put_char(&ds, '\n');
+    }
+    ds_chomp(&ds, '\n');
+
+    sysd_state_file_write(SYSD_READINESS_FILE_PATH, ds_cstr(&ds));
+    ds_destroy(&ds);
+
+} /* sysd_history_save */
+
+void
+sysd_readiness_init(void)
+{
+    sysd_start_msec = time_msec();
+    sysd_history_load();
+
+} /* sysd_readiness_init */
+
+long long int
+sysd_readiness_uptime_msec(void)
+{
+    return time_msec() - sysd_start_msec;
+
+} /* sysd_readiness_uptime_msec */
+
+/* Timestamps every h/w daemon whose Daemon:cur_hw became set since the
+ * last call. Daemons that were already ready when sysd first saw their
+ * row (e.g. after a sysd restart) are not added to the history, since the
+ * time would say nothing about their own start up. */
+void
+sysd_readiness_record(sysd_daemon_registry_t *reg)
+{
+    daemon_info_t   *daemon;
+    bool            dirty = false;
+
+    SYSD_DAEMON_FOR_EACH (daemon, reg) {
+        if (!daemon->is_hw_handler || daemon->row == NULL
+            || daemon->hw_ready_recorded) {
+            continue;
+        }
+
+        if (daemon->row->cur_hw <= 0) {
+            daemon->seen_not_ready = true;
+            continue;
+        }
+
+        daemon->hw_ready_recorded = true;
+        daemon->hw_ready_msec = sysd_readiness_uptime_msec();
+
+        if (daemon->seen_not_ready) {
+            VLOG_INFO("Daemon '%s' ready after %lld ms",
+                      daemon->name, daemon->hw_ready_msec);
+            sysd_history_push(sysd_history_get(daemon->name),
+                              daemon->hw_ready_msec);
+            dirty = true;
+        }
+    }
+
+    if (dirty) {
+        sysd_history_save();
+    }
+
+} /* sysd_readiness_record */
+
+static long long int
+sysd_daemon_timeout_msec(const sysd_daemon_registry_t *reg,
+                         const daemon_info_t *daemon)
+{
+    return daemon->ready_timeout_msec ? daemon->ready_timeout_msec
+                                      : reg->default_timeout_msec;
+
+} /* sysd_daemon_timeout_msec */
+
+/* Returns true if the watchdog still has to check 'daemon'. */
+static bool
+sysd_daemon_is_watched(const sysd_daemon_registry_t *reg,
+                       const daemon_info_t *daemon)
+{
+    return daemon->is_hw_handler && !daemon->hw_ready_recorded
+           && !daemon->deadline_missed
+           && sysd_daemon_timeout_msec(reg, daemon) > 0;
+
+} /* sysd_daemon_is_watched */
+
+/* Arms a poll-loop timer for the earliest pending daemon deadline. */
+void
+sysd_readiness_watchdog_wait(const sysd_daemon_registry_t *reg)
+{
+    const daemon_info_t *daemon;
+    long long int       next = LLONG_MAX;
+
+    SYSD_DAEMON_FOR_EACH (daemon, reg) {
+        if (sysd_daemon_is_watched(reg, daemon)) {
+            next = MIN(next, sysd_daemon_timeout_msec(reg, daemon));
+        }
+    }
+
+    if (next != LLONG_MAX) {
+        poll_timer_wait_until(sysd_start_msec + next);
+    }
+
+} /* sysd_readiness_watchdog_wait */
+
+/* Flags every h/w daemon whose deadline has passed without it setting
+ * Daemon:cur_hw. Returns true if any daemon was newly flagged. */
+bool
+sysd_readiness_watchdog_run(sysd_daemon_registry_t *reg)
+{
+    daemon_info_t   *daemon;
+    long long int   uptime = sysd_readiness_uptime_msec();
+    long long int   timeout;
+    bool            missed = false;
+
+    SYSD_DAEMON_FOR_EACH (daemon, reg) {
+        if (!sysd_daemon_is_watched(reg, daemon)) {
+            continue;
+        }
+
+        timeout = sysd_daemon_timeout_msec(reg, daemon);
+        if (uptime < timeout) {
+            continue;
+        }
+
+        daemon->deadline_missed = true;
+        missed = true;
+
+        VLOG_WARN("Daemon '%s' not ready %lld ms after sysd start",
+                  daemon->name, timeout);
+        log_event("SYS_DAEMON_READY_TIMEOUT",
+                  EV_KV("daemon", "%s", daemon->name),
+                  EV_KV("timeout", "%lld", timeout));
+    }
+
+    return missed;
+
+} /* sysd_readiness_watchdog_run */
+
+/* Stores the p50 and p99 time-to-ready of daemon 'name' over its history
+ * in '*p50' and '*p99'. Returns false if the daemon has never been timed. */
+bool
+sysd_readiness_percentiles(const char *name, long long int *p50,
+                           long long int *p99)
+{
+    const struct sysd_ready_history *h;
+
+    h = shash_find_data(&history, name);
+    if (h == NULL || h->n == 0) {
+        return false;
+    }
+
+    *p50 = sysd_history_percentile(h, 50);
+    *p99 = sysd_history_percentile(h, 99);
+
+    return true;
+
+} /* sysd_readiness_percentiles */
+
+/* Returns the number of h/w daemons that missed their deadline and are
+ * still not ready. */
+size_t
+sysd_readiness_n_late(const sysd_daemon_registry_t *reg)
+{
+    const daemon_info_t *daemon;
+    size_t              n = 0;
+
+    SYSD_DAEMON_FOR_EACH (daemon, reg) {
+        if (daemon->deadline_missed && !daemon->hw_ready_recorded) {
+            n++;
+        }
+    }
+
+    return n;
+
+} /* sysd_readiness_n_late */
+
+void
+sysd_readiness_dump(struct ds *ds, const sysd_daemon_registry_t *reg)
+{
+    const struct sysd_ready_history *h;
+    daemon_info_t   *daemon;
+
+    ds_put_format(ds, "sysd uptime: %lld ms\n",
+                  sysd_readiness_uptime_msec());
+    ds_put_format(ds, "Late daemons: %"PRIuSIZE"\n\n",
+                  sysd_readiness_n_late(reg));
+    ds_put_format(ds, "%-24s %12s %8s %10s %10s\n",
+                  "Daemon", "This boot", "Samples", "p50 (ms)", "p99 (ms)");
+
+    SYSD_DAEMON_FOR_EACH (daemon, reg) {
+        if (!daemon->is_hw_handler) {
+            continue;
+        }
+
+        ds_put_format(ds, "%-24s ", daemon->name);
+        if (!daemon->hw_ready_recorded) {
+            ds_put_format(ds, "%12s",
+                          daemon->deadline_missed ? "late" : "pending");
+        } else if (!daemon->seen_not_ready) {
+            ds_put_format(ds, "%12s", "at start");
+        } else {
+            ds_put_format(ds, "%9lld ms", daemon->hw_ready_msec);
+        }
+
+        h = shash_find_data(&history, daemon->name);
+        if (h == NULL || h->n == 0) {
+            ds_put_format(ds, " %8d %10s %10s\n", 0, "-", "-");
+        } else {
+            ds_put_format(ds, " %8"PRIuSIZE" %10lld %10lld\n", h->n,
+                          sysd_history_percentile(h, 50),
+                          sysd_history_percentile(h, 99));
+        }
+    }
+
+} /* sysd_readiness_dump */
+
+/* Returns the readiness report of sysd_readiness_dump() as a JSON object
+ * with one member per h/w daemon.  Times are in milliseconds; a daemon
+ * that has not been timed this boot has a null "this_boot". */
+struct json *
+sysd_readiness_to_json(const sysd_daemon_registry_t *reg)
+{
+    const struct sysd_ready_history *h;
+    daemon_info_t   *daemon;
+    struct json     *daemons, *entry, *json;
+    const char      *state;
+
+    daemons = json_object_create();
+    SYSD_DAEMON_FOR_EACH (daemon, reg) {
+        if (!daemon->is_hw_handler) {
+            continue;
+        }
+
+        entry = json_object_create();
+        if (!daemon->hw_ready_recorded) {
+            state = daemon->deadline_missed ? "late" : "pending";
+        } else {
+            state = daemon->seen_not_ready ? "ready" : "ready_at_start";
+        }
+        json_object_put_string(entry, "state", state);
+        json_object_put(entry, "this_boot",
+                        (daemon->hw_ready_recorded && daemon->seen_not_ready)
+                        ? json_integer_create(daemon->hw_ready_msec)
+                        : json_null_create());
+
+        h = shash_find_data(&history, daemon->name);
+        json_object_put(entry, "samples", json_integer_create(h ? h->n : 0));
+        if (h != NULL && h->n > 0) {
+            json_object_put(entry, "p50",
+                            json_integer_create(
+                                sysd_history_percentile(h, 50)));
+            json_object_put(entry, "p99",
+                            json_integer_create(
+                                sysd_history_percentile(h, 99)));
+        }
+        json_object_put(daemons, daemon->name, entry);
+    }
+
+    json = json_object_create();
+    json_object_put(json, "uptime_msec",
+                    json_integer_create(sysd_readiness_uptime_msec()));
+    json_object_put(json, "late_daemons",
+                    json_integer_create(sysd_readiness_n_late(reg)));
+    json_object_put(json, "daemons", daemons);
+
+    return json;
+
+} /* sysd_readiness_to_json */
+/** @} end of group sysd */
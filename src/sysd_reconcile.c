@@ -0,0 +1,876 @@
+/************************************************************************//**
+ * (c) Copyright 2015-2016 Hewlett Packard Enterprise Development LP
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *    not use this file except in compliance with the License. You may obtain
+ *    a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *    WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *    License for the specific language governing permissions and limitations
+ *    under the License.
+ *
+ ***************************************************************************/
+/* @ingroup sysd
+ *
+ * @file
+ * Source for reconciling the database with the h/w description.
+ *
+ * sysd derives the subsystems, their interfaces, the Daemon table, the
+ * default bridge and VRF and the QoS and ACL factory defaults from the
+ * h/w description files and the image.manifest file. sysd_reconcile()
+ * compares that desired state with the rows the IDL holds and writes
+ * only the difference: missing rows are inserted, columns sysd owns are
+ * rewritten only when they differ and rows sysd no longer describes are
+ * removed. On a fresh System row this is the initial configuration; on
+ * an existing one it lets sysd restart on a live switch without
+ * duplicating rows or touching what did not change.
+ *
+ * Configuration owned by users or by other daemons (interface admin
+ * state and user_config, the asset tag, the MAC pool already handed out,
+ * QoS trust, maps and applied profiles, any other bridge, port or VRF)
+ * is only seeded when missing and is never overwritten.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <shash.h>
+#include <smap.h>
+#include <util.h>
+#include <ovsdb-idl.h>
+#include <openswitch-idl.h>
+#include <vswitch-idl.h>
+#include <openvswitch/vlog.h>
+
+#include <ops-utils.h>
+#include <vrf-utils.h>
+#include <config-yaml.h>
+#include "qos_init.h"
+#include "acl_init.h"
+#include "sysd.h"
+#include "sysd_util.h"
+#include "sysd_daemon.h"
+#include "sysd_ovsdb_if.h"
+#include "sysd_reconcile.h"
+#include "eventlog.h"
+
+VLOG_DEFINE_THIS_MODULE(sysd_reconcile);
+
+/** @ingroup sysd
+ * @{ */
+
+extern char *g_hw_desc_dir;
+
+struct sysd_reconciler {
+    struct ovsdb_idl_txn            *txn;
+    struct ovsrec_system            *sys;
+    bool                            sys_created;
+    struct sysd_reconcile_stats     *stats;
+};
+
+static bool
+sysd_streq(const char *a, const char *b)
+{
+    return (a == b) || (a != NULL && b != NULL && !strcmp(a, b));
+
+} /* sysd_streq */
+
+/* Counts a column write, unless it is part of filling in a row inserted
+ * by this pass. */
+static void
+sysd_reconcile_note_update(struct sysd_reconciler *r, bool created)
+{
+    if (!created) {
+        r->stats->n_updated++;
+    }
+
+} /* sysd_reconcile_note_update */
+
+static void
+sysd_get_speeds_string(char *speed_str, int len, int **speeds)
+{
+    int     i = 0;
+    char    buf[10];
+
+    while(speeds[i] != NULL) {
+        if (i == 0) {
+            snprintf(buf, sizeof(buf), "%d", *speeds[i]);
+        } else {
+            snprintf(buf, sizeof(buf), ",%d", *speeds[i]);
+        }
+        strncat(speed_str, buf, len);
+        i++;
+    }
+} /* sysd_get_speeds_string */
+
+static void
+sysd_interface_hw_info(const sysd_subsystem_t *subsys_ptr,
+                       const sysd_intf_info_t *intf_ptr,
+                       struct smap *hw_intf_info)
+{
+    char                        *tmp_p;
+    char                        buf[128];
+    char                        **cap_p;
+
+    tmp_p = (intf_ptr->pluggable) ? INTERFACE_HW_INTF_INFO_MAP_PLUGGABLE_TRUE
+        : INTERFACE_HW_INTF_INFO_MAP_PLUGGABLE_FALSE;
+    smap_add(hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_PLUGGABLE, tmp_p);
+    smap_add(hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_CONNECTOR, intf_ptr->connector);
+
+    smap_add_format(hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_MAX_SPEED,
+                    "%d", intf_ptr->max_speed);
+
+    memset(buf, 0, sizeof(buf));
+    sysd_get_speeds_string(buf, sizeof(buf), intf_ptr->speeds);
+    smap_add(hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_SPEEDS, buf);
+
+
+    smap_add_format(hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_SWITCH_UNIT,
+                    "%d", intf_ptr->device);
+    smap_add_format(hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_SWITCH_INTF_ID,
+                    "%d", intf_ptr->device_port);
+
+    /* Add interface capabilities
+     * Check for known values and add them. If an unknown capability is given,
+     * log (info) it and go ahead and add it.
+    */
+    cap_p = intf_ptr->capabilities;
+
+    while (*cap_p != (char *) NULL) {
+        if ((strcmp(*cap_p, INTERFACE_HW_INTF_INFO_MAP_SPLIT_4) != 0)  &&
+            (strcmp(*cap_p, INTERFACE_HW_INTF_INFO_MAP_ENET1G)  != 0)  &&
+            (strcmp(*cap_p, INTERFACE_HW_INTF_INFO_MAP_ENET10G) != 0)  &&
+            (strcmp(*cap_p, INTERFACE_HW_INTF_INFO_MAP_ENET25G) != 0)  &&
+            (strcmp(*cap_p, INTERFACE_HW_INTF_INFO_MAP_ENET40G) != 0)  &&
+            (strcmp(*cap_p, INTERFACE_HW_INTF_INFO_MAP_ENET100G) != 0)) {
+
+            VLOG_INFO("subsystem[%s]:interface[%s] - adding unknown "
+                      "interface capability[%s]",
+                             subsys_ptr->name, intf_ptr->name, *cap_p);
+        }
+
+        smap_add(hw_intf_info, *cap_p, "true");
+        cap_p++;
+    }
+
+    /* All the interfaces in a subsystem uses the same MAC address.
+     * Copy the subsystem system MAC to interface hw_info:mac_addres.
+     */
+    if (subsys_ptr->system_mac_addr) {
+        memset(buf, 0, sizeof(buf));
+        tmp_p = ops_ether_ulong_long_to_string(buf, subsys_ptr->system_mac_addr);
+        smap_add(hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_MAC_ADDR, tmp_p);
+    }
+
+    /*
+     * OPS_TODO:
+     * Current schema has in-correct values for interface table.
+     * Once we fix all that, need to fix the following code.
+     *
+     * unsigned int                speed_count = 0;
+     * ovsrec_interface_set_connector(ovs_intf, intf_ptr->connector);
+     * ovsrec_interface_set_max_speed(ovs_intf, &(intf_ptr->max_speed), 1);
+     * speed_count = get_count_null_ended((void *) intf_ptr->speeds);
+     * ovsrec_interface_set_link_speed(ovs_intf, intf_ptr->speeds, speed_count); */
+
+} /* sysd_interface_hw_info */
+
+/* Brings the columns sysd owns on 'ovs_intf' in line with 'intf_ptr'.
+ * admin_state and user_config belong to the user once the row exists. */
+static void
+sysd_reconcile_interface(struct sysd_reconciler *r,
+                         const sysd_subsystem_t *subsys_ptr,
+                         const sysd_intf_info_t *intf_ptr,
+                         const struct ovsrec_interface *ovs_intf,
+                         bool created)
+{
+    struct smap     hw_intf_info = SMAP_INITIALIZER(&hw_intf_info);
+
+    if (created) {
+        ovsrec_interface_set_name(ovs_intf, intf_ptr->name);
+        ovsrec_interface_set_admin_state(ovs_intf,
+                                         OVSREC_INTERFACE_ADMIN_STATE_DOWN);
+    }
+
+    if (!sysd_streq(ovs_intf->type, OVSREC_INTERFACE_TYPE_SYSTEM)) {
+        ovsrec_interface_set_type(ovs_intf, OVSREC_INTERFACE_TYPE_SYSTEM);
+        sysd_reconcile_note_update(r, created);
+    }
+
+    sysd_interface_hw_info(subsys_ptr, intf_ptr, &hw_intf_info);
+    if (!smap_equal(&hw_intf_info, &ovs_intf->hw_intf_info)) {
+        ovsrec_interface_set_hw_intf_info(ovs_intf, &hw_intf_info);
+        sysd_reconcile_note_update(r, created);
+    }
+    smap_destroy(&hw_intf_info);
+
+} /* sysd_reconcile_interface */
+
+/* Returns true if 'row' holds exactly the interfaces in 'intfs'. */
+static bool
+sysd_split_children_equal(const struct ovsrec_interface *row,
+                          struct ovsrec_interface **intfs, size_t n)
+{
+    size_t  i, j;
+
+    if (row->n_split_children != n) {
+        return false;
+    }
+
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < row->n_split_children; j++) {
+            if (row->split_children[j] == intfs[i]) {
+                break;
+            }
+        }
+        if (j == row->n_split_children) {
+            return false;
+        }
+    }
+
+    return true;
+
+} /* sysd_split_children_equal */
+
+/* Sets the split parent and children of the interfaces of 'subsys_ptr',
+ * whose rows are in 'ovs_intf' and indexed by name in 'by_name'. */
+static void
+sysd_reconcile_split_ports(struct sysd_reconciler *r,
+                           const sysd_subsystem_t *subsys_ptr,
+                           struct ovsrec_interface **ovs_intf,
+                           const bool *created,
+                           const struct shash *by_name)
+{
+    int                 i = 0;
+    sysd_intf_info_t    *intf_ptr = NULL;
+
+    for (i = 0; i < subsys_ptr->intf_count; i++) {
+        struct ovsrec_interface *parent = NULL;
+        struct ovsrec_interface *subports[SYSD_MAX_SPLIT_PORTS];
+        int j = 0, k = 0;
+
+        intf_ptr = subsys_ptr->interfaces[i];
+
+        if (intf_ptr->parent_port != NULL) {
+            parent = shash_find_data(by_name, intf_ptr->parent_port);
+            if (parent == NULL) {
+                VLOG_WARN("Unable to find parent port %s of subport %s",
+                          intf_ptr->parent_port, intf_ptr->name);
+            }
+        }
+        if (ovs_intf[i]->split_parent != parent) {
+            ovsrec_interface_set_split_parent(ovs_intf[i], parent);
+            sysd_reconcile_note_update(r, created[i]);
+        }
+
+        while (k < SYSD_MAX_SPLIT_PORTS && intf_ptr->subports[k] != NULL) {
+            subports[j] = shash_find_data(by_name, intf_ptr->subports[k]);
+            if (subports[j] == NULL) {
+                VLOG_WARN("Unable to find subport %s of port %s",
+                          intf_ptr->subports[k], intf_ptr->name);
+            } else {
+                j++;
+            }
+            k++;
+        }
+        if (!sysd_split_children_equal(ovs_intf[i], subports, j)) {
+            ovsrec_interface_set_split_children(ovs_intf[i], subports, j);
+            sysd_reconcile_note_update(r, created[i]);
+        }
+    }
+
+} /* sysd_reconcile_split_ports */
+
+/* Interface rows are matched by name. An interface the h/w description
+ * no longer lists is only dropped from Subsystem:interfaces: Interface is
+ * not a root table, so the database removes the row once no Port refers
+ * to it either. */
+static void
+sysd_reconcile_interfaces(struct sysd_reconciler *r,
+                          const sysd_subsystem_t *subsys_ptr,
+                          const struct ovsrec_subsystem *ovs_subsys,
+                          bool subsys_created)
+{
+    int                         i = 0;
+    bool                        changed = subsys_created;
+    bool                        *created = NULL;
+    struct shash                existing = SHASH_INITIALIZER(&existing);
+    struct shash                by_name = SHASH_INITIALIZER(&by_name);
+    struct shash_node           *node;
+    struct ovsrec_interface     **ovs_intf = NULL;
+
+    ovs_intf = SYSD_OVS_PTR_CALLOC(ovsrec_interface *, subsys_ptr->intf_count);
+    created = calloc(subsys_ptr->intf_count, sizeof *created);
+    if (ovs_intf == NULL || created == NULL) {
+        VLOG_ERR("Failed to allocate memory for OVS subsystem interfaces.");
+        log_event("SYS_ALLOCATE_MEMORY_FAILURE", EV_KV("value",
+            "%s", "OVS subsystem interfaces"));
+        free(ovs_intf);
+        free(created);
+        return;
+    }
+
+    for (i = 0; i < ovs_subsys->n_interfaces; i++) {
+        const struct ovsrec_interface *row = ovs_subsys->interfaces[i];
+
+        if (!shash_add_once(&existing, row->name, row)) {
+            VLOG_INFO("Dropping duplicate interface %s from subsystem %s",
+                      row->name, subsys_ptr->name);
+            r->stats->n_removed++;
+            changed = true;
+        }
+    }
+
+    for (i = 0; i < subsys_ptr->intf_count; i++) {
+        sysd_intf_info_t *intf_ptr = subsys_ptr->interfaces[i];
+        const struct ovsrec_interface *row;
+
+        row = shash_find_and_delete(&existing, intf_ptr->name);
+        if (row == NULL) {
+            row = ovsrec_interface_insert(r->txn);
+            created[i] = true;
+            r->stats->n_inserted++;
+            changed = true;
+        }
+        sysd_reconcile_interface(r, subsys_ptr, intf_ptr, row, created[i]);
+
+        ovs_intf[i] = CONST_CAST(struct ovsrec_interface *, row);
+        shash_add_once(&by_name, intf_ptr->name, row);
+    }
+
+    SHASH_FOR_EACH (node, &existing) {
+        VLOG_INFO("Interface %s is no longer described for subsystem %s, "
+                  "dropping it", node->name, subsys_ptr->name);
+        r->stats->n_removed++;
+        changed = true;
+    }
+
+    sysd_reconcile_split_ports(r, subsys_ptr, ovs_intf, created, &by_name);
+
+    if (changed) {
+        ovsrec_subsystem_set_interfaces(ovs_subsys, ovs_intf,
+                                        subsys_ptr->intf_count);
+        sysd_reconcile_note_update(r, subsys_created);
+    }
+
+    shash_destroy(&by_name);
+    shash_destroy(&existing);
+    free(created);
+    free(ovs_intf);
+
+} /* sysd_reconcile_interfaces */
+
+static void
+sysd_subsystem_other_info(const sysd_subsystem_t *subsys_ptr,
+                          struct smap *other_info)
+{
+    const fru_eeprom_t          *fru = &(subsys_ptr->fru_eeprom);
+
+    smap_add(other_info, "country_code", fru->country_code);
+    smap_add_format(other_info, "device_version", "%c", fru->device_version);
+    smap_add(other_info, "diag_version", fru->diag_version ? : "");
+    smap_add(other_info, "label_revision", fru->label_revision ? : "");
+    smap_add_format(other_info, "base_mac_address",
+                    "%02x:%02x:%02x:%02x:%02x:%02x",
+                    SYSD_MAC_FORMAT(fru->base_mac_address));
+    smap_add_format(other_info, "number_of_macs", "%d", fru->num_macs);
+    smap_add(other_info, "manufacturer", fru->manufacturer ? : "");
+    smap_add(other_info, "manufacture_date", fru->manufacture_date);
+    smap_add(other_info, "onie_version", fru->onie_version ? : "");
+    smap_add(other_info, "part_number", fru->part_number ? : "");
+    smap_add(other_info, "Product Name", fru->product_name ? : "");
+    smap_add(other_info, "platform_name", fru->platform_name ? : "");
+    smap_add(other_info, "serial_number", fru->serial_number ? : "");
+    smap_add(other_info, "vendor", fru->vendor ? : "");
+
+    smap_add_format(other_info, "interface_count",
+                    "%d", subsys_ptr->intf_cmn_info->number_ports);
+    smap_add_format(other_info, "max_interface_speed",
+                    "%d", subsys_ptr->intf_cmn_info->max_port_speed);
+    smap_add_format(other_info, "max_transmission_unit",
+                    "%d", subsys_ptr->intf_cmn_info->max_transmission_unit);
+    smap_add_format(other_info, "max_bond_count",
+                    "%d", subsys_ptr->intf_cmn_info->max_lag_count);
+    smap_add_format(other_info, "max_bond_member_count",
+                    "%d", subsys_ptr->intf_cmn_info->max_lag_member_count);
+    smap_add_format(other_info, "l3_port_requires_internal_vlan",
+                    "%d", subsys_ptr->intf_cmn_info->l3_port_requires_internal_vlan);
+
+} /* sysd_subsystem_other_info */
+
+/* Reconciles 'subsys_ptr' with its row 'ovs_subsys', inserting the row if
+ * it is NULL, and returns the row. The asset tag and the MAC pool are
+ * only set on a new row: the MACs already handed out must not be handed
+ * out again after a restart. */
+static const struct ovsrec_subsystem *
+sysd_reconcile_subsystem(struct sysd_reconciler *r,
+                         const sysd_subsystem_t *subsys_ptr,
+                         const struct ovsrec_subsystem *ovs_subsys)
+{
+    bool                        created = (ovs_subsys == NULL);
+    char                        mac_addr[32];
+    char                        *tmp_p;
+    struct smap                 owned = SMAP_INITIALIZER(&owned);
+    struct smap                 other_info;
+    struct smap_node            *node;
+
+    if (created) {
+        ovs_subsys = ovsrec_subsystem_insert(r->txn);
+        r->stats->n_inserted++;
+
+        ovsrec_subsystem_set_name(ovs_subsys, subsys_ptr->name);
+        ovsrec_subsystem_set_asset_tag_number(ovs_subsys, DFLT_ASSET_TAG);
+
+        /* Save next_mac_address and macs_remaining in subsystem */
+        memset(mac_addr, 0, sizeof(mac_addr));
+        tmp_p = ops_ether_ulong_long_to_string(mac_addr, subsys_ptr->nxt_mac_addr);
+        ovsrec_subsystem_set_next_mac_address(ovs_subsys, tmp_p);
+        ovsrec_subsystem_set_macs_remaining(ovs_subsys, subsys_ptr->num_free_macs);
+    }
+
+    if (!sysd_streq(ovs_subsys->hw_desc_dir, g_hw_desc_dir)) {
+        ovsrec_subsystem_set_hw_desc_dir(ovs_subsys, g_hw_desc_dir);
+        sysd_reconcile_note_update(r, created);
+    }
+
+    /* Only replace the keys sysd owns, other daemons may add their own. */
+    sysd_subsystem_other_info(subsys_ptr, &owned);
+    smap_clone(&other_info, &ovs_subsys->other_info);
+    SMAP_FOR_EACH (node, &owned) {
+        smap_replace(&other_info, node->key, node->value);
+    }
+    if (!smap_equal(&other_info, &ovs_subsys->other_info)) {
+        ovsrec_subsystem_set_other_info(ovs_subsys, &other_info);
+        sysd_reconcile_note_update(r, created);
+    }
+    smap_destroy(&other_info);
+    smap_destroy(&owned);
+
+    sysd_reconcile_interfaces(r, subsys_ptr, ovs_subsys, created);
+
+    return ovs_subsys;
+
+} /* sysd_reconcile_subsystem */
+
+static void
+sysd_reconcile_subsystems(struct sysd_reconciler *r)
+{
+    int                         i = 0;
+    bool                        changed = false;
+    struct shash                existing = SHASH_INITIALIZER(&existing);
+    struct shash_node           *node;
+    struct ovsrec_subsystem     **ovs_subsys_l = NULL;
+
+    ovs_subsys_l = SYSD_OVS_PTR_CALLOC(ovsrec_subsystem *, num_subsystems);
+    if (ovs_subsys_l == NULL) {
+        VLOG_ERR("Failed to allocate memory for OVS subsystem.");
+        log_event("SYS_ALLOCATE_MEMORY_FAILURE", EV_KV("value",
+            "%s", "OVS subsystem"));
+        return;
+    }
+
+    for (i = 0; i < r->sys->n_subsystems; i++) {
+        const struct ovsrec_subsystem *row = r->sys->subsystems[i];
+
+        if (!shash_add_once(&existing, row->name, row)) {
+            VLOG_INFO("Removing duplicate subsystem %s", row->name);
+            ovsrec_subsystem_delete(row);
+            r->stats->n_removed++;
+            changed = true;
+        }
+    }
+
+    for (i = 0; i < num_subsystems; i++) {
+        const struct ovsrec_subsystem *row;
+
+        row = shash_find_and_delete(&existing, subsystems[i]->name);
+        if (row == NULL) {
+            changed = true;
+        }
+        row = sysd_reconcile_subsystem(r, subsystems[i], row);
+        ovs_subsys_l[i] = CONST_CAST(struct ovsrec_subsystem *, row);
+    }
+
+    SHASH_FOR_EACH (node, &existing) {
+        VLOG_INFO("Subsystem %s is no longer present, removing it",
+                  node->name);
+        ovsrec_subsystem_delete(node->data);
+        r->stats->n_removed++;
+        changed = true;
+    }
+
+    if (changed) {
+        ovsrec_system_set_subsystems(r->sys, ovs_subsys_l, num_subsystems);
+        sysd_reconcile_note_update(r, r->sys_created);
+    }
+
+    shash_destroy(&existing);
+    free(ovs_subsys_l);
+
+} /* sysd_reconcile_subsystems */
+
+/* Daemon rows are matched by name. cur_hw belongs to the daemon once the
+ * row exists, so only is_hw_handler is kept in line with the manifest. */
+static void
+sysd_reconcile_daemons(struct sysd_reconciler *r)
+{
+    int                         i = 0;
+    bool                        changed = false;
+    daemon_info_t               *daemon = NULL;
+    struct shash                existing = SHASH_INITIALIZER(&existing);
+    struct shash_node           *node;
+    struct ovsrec_daemon        **ovs_daemon_l = NULL;
+
+    ovs_daemon_l = SYSD_OVS_PTR_CALLOC(ovsrec_daemon *,
+                                       daemon_registry.n_daemons);
+    if (ovs_daemon_l == NULL) {
+        VLOG_ERR("Failed to allocate memory for OVS daemon table.");
+        log_event("SYS_ALLOCATE_MEMORY_FAILURE", EV_KV("value",
+            "%s", "OVS daemon table"));
+        return;
+    }
+
+    for (i = 0; i < r->sys->n_daemons; i++) {
+        const struct ovsrec_daemon *row = r->sys->daemons[i];
+
+        if (!shash_add_once(&existing, row->name, row)) {
+            VLOG_INFO("Removing duplicate daemon %s", row->name);
+            ovsrec_daemon_delete(row);
+            r->stats->n_removed++;
+            changed = true;
+        }
+    }
+
+    i = 0;
+    SYSD_DAEMON_FOR_EACH (daemon, &daemon_registry) {
+        const struct ovsrec_daemon *row;
+
+        row = shash_find_and_delete(&existing, daemon->name);
+        if (row == NULL) {
+            row = ovsrec_daemon_insert(r->txn);
+            ovsrec_daemon_set_name(row, daemon->name);
+            ovsrec_daemon_set_cur_hw(row, daemon->cur_hw);
+            ovsrec_daemon_set_is_hw_handler(row, daemon->is_hw_handler);
+            daemon->seen_not_ready = !daemon->cur_hw;
+            r->stats->n_inserted++;
+            changed = true;
+        } else if (row->is_hw_handler != daemon->is_hw_handler) {
+            ovsrec_daemon_set_is_hw_handler(row, daemon->is_hw_handler);
+            r->stats->n_updated++;
+        }
+        ovs_daemon_l[i++] = CONST_CAST(struct ovsrec_daemon *, row);
+    }
+
+    SHASH_FOR_EACH (node, &existing) {
+        VLOG_INFO("Daemon %s is no longer in the manifest, removing it",
+                  node->name);
+        ovsrec_daemon_delete(node->data);
+        r->stats->n_removed++;
+        changed = true;
+    }
+
+    if (changed) {
+        ovsrec_system_set_daemons(r->sys, ovs_daemon_l,
+                                  daemon_registry.n_daemons);
+        sysd_reconcile_note_update(r, r->sys_created);
+    }
+
+    shash_destroy(&existing);
+    free(ovs_daemon_l);
+
+} /* sysd_reconcile_daemons */
+
+static void
+sysd_reconcile_system_macs(struct sysd_reconciler *r)
+{
+    char    mac_addr[32];
+    char    *tmp_p;
+
+    /* OPS_TODO: Need to update for multiple subsystem
+     * for now, assume that subsystem[0] is the base subsystem and use
+     * the mgmt MAC for the base subsystem as the system wide mgmt MAC.
+    */
+    memset(mac_addr, 0, sizeof(mac_addr));
+    tmp_p = ops_ether_ulong_long_to_string(mac_addr, subsystems[0]->mgmt_mac_addr);
+    if (!sysd_streq(r->sys->management_mac, tmp_p)) {
+        ovsrec_system_set_management_mac(r->sys, tmp_p);
+        sysd_reconcile_note_update(r, r->sys_created);
+    }
+
+    /* Assign general use MAC */
+    /* OPS_TODO: Using subsystem[0] for now */
+    memset(mac_addr, 0, sizeof(mac_addr));
+    tmp_p = ops_ether_ulong_long_to_string(mac_addr, subsystems[0]->system_mac_addr);
+    if (!sysd_streq(r->sys->system_mac, tmp_p)) {
+        ovsrec_system_set_system_mac(r->sys, tmp_p);
+        sysd_reconcile_note_update(r, r->sys_created);
+    }
+
+} /* sysd_reconcile_system_macs */
+
+/* Only the mgmt i/f name comes from the manifest; the rest of
+ * System:mgmt_intf is configured by the user. */
+static void
+sysd_reconcile_mgmt_intf(struct sysd_reconciler *r)
+{
+    struct smap     smap;
+
+    if (sysd_streq(smap_get(&r->sys->mgmt_intf, SYSTEM_MGMT_INTF_MAP_NAME),
+                   mgmt_intf->name)) {
+        return;
+    }
+
+    smap_clone(&smap, &r->sys->mgmt_intf);
+    smap_replace(&smap, SYSTEM_MGMT_INTF_MAP_NAME, mgmt_intf->name);
+    ovsrec_system_set_mgmt_intf(r->sys, &smap);
+    smap_destroy(&smap);
+    sysd_reconcile_note_update(r, r->sys_created);
+
+} /* sysd_reconcile_mgmt_intf */
+
+/*
+ * For every bridge we will create a bridge port and a bridge
+ * internal interface under it. The bridge internal interface
+ * will be used for internal interfaces such as vlan interfaces.
+ * For vlan interfaces, all vlan tagged frames for vlan interfaces
+ * will be sent up to bridge interface.
+ * bridge interface will distribute them to the appropriate vlan
+ * interfaces which will be created on top of the bridge interface.
+ */
+static struct ovsrec_interface *
+sysd_bridge_interface_insert(struct sysd_reconciler *r)
+{
+    struct ovsrec_interface *iface = NULL;
+    struct smap hw_intf_info, user_config;
+
+    /* Create bridge internal interface */
+    iface = ovsrec_interface_insert(r->txn);
+    ovsrec_interface_set_name(iface, DEFAULT_BRIDGE_NAME);
+    ovsrec_interface_set_type(iface, OVSREC_INTERFACE_TYPE_INTERNAL);
+
+    smap_init(&hw_intf_info);
+    smap_add(&hw_intf_info, INTERFACE_HW_INTF_INFO_MAP_BRIDGE,
+             INTERFACE_HW_INTF_INFO_MAP_BRIDGE_TRUE);
+    ovsrec_interface_set_hw_intf_info(iface, &hw_intf_info);
+    smap_destroy(&hw_intf_info);
+
+    /*
+     * bridge interface is used internally. Essentially
+     * we do not expect user to configure this interface.
+     * We will set the 'admin' to up as we create it.
+     */
+    smap_init(&user_config);
+    smap_add(&user_config, INTERFACE_USER_CONFIG_MAP_ADMIN,
+             OVSREC_INTERFACE_USER_CONFIG_ADMIN_UP);
+
+    ovsrec_interface_set_user_config(iface, &user_config);
+    smap_destroy(&user_config);
+
+    r->stats->n_inserted++;
+    return iface;
+
+} /* sysd_bridge_interface_insert */
+
+static struct ovsrec_port *
+sysd_bridge_port_insert(struct sysd_reconciler *r)
+{
+    struct ovsrec_port *port = NULL;
+    struct ovsrec_interface *iface = sysd_bridge_interface_insert(r);
+
+    /* Create port for bridge */
+    port = ovsrec_port_insert(r->txn);
+    ovsrec_port_set_name(port, DEFAULT_BRIDGE_NAME);
+
+    /* Add the internal interface to port */
+    ovsrec_port_set_interfaces(port, &iface, 1);
+
+    r->stats->n_inserted++;
+    return port;
+
+} /* sysd_bridge_port_insert */
+
+/*
+ * Makes sure the default bridge, its bridge port and the bridge internal
+ * interface exist. Other bridges and the other ports of the default
+ * bridge are user configuration and are left alone.
+ */
+static void
+sysd_reconcile_default_bridge(struct sysd_reconciler *r)
+{
+    const struct ovsrec_bridge *bridge = NULL;
+    const struct ovsrec_port *port = NULL;
+    const struct ovsrec_interface *iface = NULL;
+    size_t i;
+
+    for (i = 0; i < r->sys->n_bridges && bridge == NULL; i++) {
+        if (sysd_streq(r->sys->bridges[i]->name, DEFAULT_BRIDGE_NAME)) {
+            bridge = r->sys->bridges[i];
+        }
+    }
+
+    if (bridge == NULL) {
+        struct ovsrec_bridge **bridges;
+        struct ovsrec_port *new_port;
+
+        /* Create bridge */
+        bridge = ovsrec_bridge_insert(r->txn);
+        ovsrec_bridge_set_name(bridge, DEFAULT_BRIDGE_NAME);
+        r->stats->n_inserted++;
+
+        /* Add port to the bridge */
+        new_port = sysd_bridge_port_insert(r);
+        ovsrec_bridge_set_ports(bridge, &new_port, 1);
+
+        bridges = xmalloc(sizeof *bridges * (r->sys->n_bridges + 1));
+        memcpy(bridges, r->sys->bridges, sizeof *bridges * r->sys->n_bridges);
+        bridges[r->sys->n_bridges] = CONST_CAST(struct ovsrec_bridge *, bridge);
+        ovsrec_system_set_bridges(r->sys, bridges, r->sys->n_bridges + 1);
+        sysd_reconcile_note_update(r, r->sys_created);
+        free(bridges);
+        return;
+    }
+
+    for (i = 0; i < bridge->n_ports && port == NULL; i++) {
+        if (sysd_streq(bridge->ports[i]->name, DEFAULT_BRIDGE_NAME)) {
+            port = bridge->ports[i];
+        }
+    }
+
+    if (port == NULL) {
+        struct ovsrec_port **ports;
+
+        ports = xmalloc(sizeof *ports * (bridge->n_ports + 1));
+        memcpy(ports, bridge->ports, sizeof *ports * bridge->n_ports);
+        ports[bridge->n_ports] = sysd_bridge_port_insert(r);
+        ovsrec_bridge_set_ports(bridge, ports, bridge->n_ports + 1);
+        r->stats->n_updated++;
+        free(ports);
+        return;
+    }
+
+    for (i = 0; i < port->n_interfaces && iface == NULL; i++) {
+        if (sysd_streq(port->interfaces[i]->name, DEFAULT_BRIDGE_NAME)) {
+            iface = port->interfaces[i];
+        }
+    }
+
+    if (iface == NULL) {
+        struct ovsrec_interface **ifaces;
+
+        ifaces = xmalloc(sizeof *ifaces * (port->n_interfaces + 1));
+        memcpy(ifaces, port->interfaces, sizeof *ifaces * port->n_interfaces);
+        ifaces[port->n_interfaces] = sysd_bridge_interface_insert(r);
+        ovsrec_port_set_interfaces(port, ifaces, port->n_interfaces + 1);
+        r->stats->n_updated++;
+        free(ifaces);
+    }
+
+} /* sysd_reconcile_default_bridge */
+
+/*
+ * Makes sure the default VRF exists with table id 0 and its namespace
+ * status. Other VRFs are user configuration and are left alone.
+ */
+static void
+sysd_reconcile_default_vrf(struct sysd_reconciler *r)
+{
+    const struct ovsrec_vrf *default_vrf_row = NULL;
+    struct smap smap_vrf_status;
+    const int64_t table_id = 0;
+    bool created = false;
+    size_t i;
+
+    for (i = 0; i < r->sys->n_vrfs && default_vrf_row == NULL; i++) {
+        if (sysd_streq(r->sys->vrfs[i]->name, DEFAULT_VRF_NAME)) {
+            default_vrf_row = r->sys->vrfs[i];
+        }
+    }
+
+    if (default_vrf_row == NULL) {
+        struct ovsrec_vrf **vrfs;
+
+        default_vrf_row = ovsrec_vrf_insert(r->txn);
+        ovsrec_vrf_set_name(default_vrf_row, DEFAULT_VRF_NAME);
+        r->stats->n_inserted++;
+        created = true;
+
+        vrfs = xmalloc(sizeof *vrfs * (r->sys->n_vrfs + 1));
+        memcpy(vrfs, r->sys->vrfs, sizeof *vrfs * r->sys->n_vrfs);
+        vrfs[r->sys->n_vrfs] = CONST_CAST(struct ovsrec_vrf *, default_vrf_row);
+        ovsrec_system_set_vrfs(r->sys, vrfs, r->sys->n_vrfs + 1);
+        sysd_reconcile_note_update(r, r->sys_created);
+        free(vrfs);
+    }
+
+    if (default_vrf_row->n_table_id != 1
+        || default_vrf_row->table_id[0] != table_id) {
+        ovsrec_vrf_set_table_id(default_vrf_row, &table_id, 1);
+        sysd_reconcile_note_update(r, created);
+    }
+
+    if (smap_get(&default_vrf_row->status, VRF_STATUS_KEY) == NULL) {
+        smap_clone(&smap_vrf_status, &default_vrf_row->status);
+        smap_add_once(&smap_vrf_status, VRF_STATUS_KEY, VRF_STATUS_VALUE);
+
+        ovsrec_vrf_set_status(default_vrf_row, &smap_vrf_status);
+        smap_destroy(&smap_vrf_status);
+        sysd_reconcile_note_update(r, created);
+    }
+
+} /* sysd_reconcile_default_vrf */
+
+/*
+ * Reconciles the database behind 'txn' with the h/w description files
+ * and the image.manifest file, using 'sys' as the System row. 'sys_created'
+ * tells that 'sys' was inserted in 'txn', in which case this is the
+ * initial configuration. The interface info of the subsystems must be
+ * loaded. What was written is added to 'stats'.
+ */
+void
+sysd_reconcile(struct ovsdb_idl_txn *txn, struct ovsrec_system *sys,
+               bool sys_created, struct sysd_reconcile_stats *stats)
+{
+    struct sysd_reconciler r = {
+        .txn = txn,
+        .sys = sys,
+        .sys_created = sys_created,
+        .stats = stats,
+    };
+
+    memset(stats, 0, sizeof *stats);
+    if (sys_created) {
+        stats->n_inserted++;
+    }
+
+    /* Add the interface name to ovsdb */
+    sysd_reconcile_mgmt_intf(&r);
+
+    /* Add default bridge and VRF rows */
+    sysd_reconcile_default_bridge(&r);
+    sysd_reconcile_default_vrf(&r);
+
+    /* Assign system wide mgmt i/f MAC address and general use MAC */
+    sysd_reconcile_system_macs(&r);
+
+    /* Add the subsystem info to OVSDB */
+    sysd_reconcile_subsystems(&r);
+
+    /* Add the daemon info to the daemon table */
+    sysd_reconcile_daemons(&r);
+
+    /* QoS init */
+    qos_init_trust(txn, sys);
+    qos_init_dscp_map(txn, sys);
+    qos_init_cos_map(txn, sys);
+    qos_init_queue_profile(txn, sys);
+    qos_init_schedule_profile(txn, sys);
+    /* ACL init */
+    acl_init_limits(txn, sys);
+
+} /* sysd_reconcile */
+/** @} end of group sysd */
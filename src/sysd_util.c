@@ -30,8 +30,9 @@
 
 #include "util.h"
 #include "openvswitch/vlog.h"
-#include "json.h"
 #include "sysd_util.h"
+#include "sysd_arena.h"
+#include "sysd_manifest.h"
 
 #include <config-yaml.h>
 #include "sysd_cfg_yaml.h"
@@ -44,8 +45,6 @@ VLOG_DEFINE_THIS_MODULE(sysd_util);
 /** @ingroup sysd
  * @{ */
 
-struct json *manifest_info = NULL;
-
 #ifndef PLATFORM_SIMULATION
 static char *
 strip_quotes(char *string)
@@ -148,7 +147,7 @@ create_link_to_desc_files(char *manufacturer, char *product_name)
 
     VLOG_INFO("Location to HW descrptor files: %s", hw_desc_dir);
 
-    g_hw_desc_dir = strdup(hw_desc_dir);
+    g_hw_desc_dir = sysd_arena_strdup(&sysd_boot_arena, hw_desc_dir);
 
     if (stat(hw_desc_dir, &sbuf) != 0) {
         VLOG_ERR("Unable to find hardware description files at %s", hw_desc_dir);
@@ -227,234 +226,119 @@ calc_crc(unsigned char *buf, int len)
 
 } /* calc_crc() */
 
-static void
-_sysd_get_hw_handler(struct shash *object) {
-    const struct shash_node *dnode;
-    struct json *jp;
-
-    SHASH_FOR_EACH (dnode, object) {
-        if (strncmp(dnode->name, HW_HANDLER_TAG, strlen(HW_HANDLER_TAG))
-                                                        == 0) {
-            jp = dnode->data;
-            switch (jp->type) {
-                case JSON_TRUE:
-                    daemons[num_daemons]->is_hw_handler = true;
-                    break;
-                case JSON_FALSE:
-                    /* Fall through */
-                default:
-                    daemons[num_daemons]->is_hw_handler = false;
-                    break;
-            }
-            return;
-        }
-    }
-    return;
-} /*_sysd_get_hw_handler() */
-
 static int
-_sysd_process_daemons(struct shash *object) {
-    const struct shash_node *dnode;
-    char hostname[128];
-    int ret;
-
-    ret = gethostname(hostname, sizeof(hostname));
-    if(ret < 0)
-        VLOG_ERR("hostname:%s ret errno: %s", hostname, strerror(errno));
-
-    SHASH_FOR_EACH (dnode, object) {
-        daemons = realloc(daemons, sizeof(daemon_info_t*)*(num_daemons+1));
-        daemons[num_daemons] = calloc(sizeof(daemon_info_t), 1);
-        if (daemons[num_daemons] == (daemon_info_t *) NULL) {
-            VLOG_ERR("Error processing daemon information");
-            return (-1);
-        }
-
-        strncpy(daemons[num_daemons]->name, dnode->name, strlen(dnode->name));
+sysd_state_dir_create(void)
+{
+    int rc;
 
-        /* If this row is sysd, then go ahead and set cur_hw = 1 since
-           ...everything is being done in one transaction. */
+    rc = mkdir(SYSD_STATE_DIR, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+    if (rc == -1 && errno != EEXIST) {
+        VLOG_ERR("Failed to create %s, Error %s",
+                 SYSD_STATE_DIR, ovs_strerror(errno));
+        return -1;
+    }
 
-        if (strncmp(daemons[num_daemons]->name, NAME_IN_DAEMON_TABLE,
-                    strlen(NAME_IN_DAEMON_TABLE)) == 0 ) {
-            daemons[num_daemons]->cur_hw = 1;
-        }
-        else
-        {
-            daemons[num_daemons]->cur_hw = 0;
-        }
+    return 0;
 
-        _sysd_get_hw_handler(json_object(dnode->data));
+} /* sysd_state_dir_create */
 
-        VLOG_INFO("%s daemons_manifest:'%s', daemons_manifest_cur_hw %d, "
-                  "daemons_manifest_is_hw_handler %d", hostname,
-                  daemons[num_daemons]->name, (int)(daemons[num_daemons]->cur_hw),
-                  (int)(daemons[num_daemons]->is_hw_handler));
-        num_daemons++;
+/*
+ * Returns the first line of the sysd state file at 'path', without the
+ * trailing newline, or NULL if the file does not exist or is empty.
+ * Caller must free the returned string.
+ */
+char *
+sysd_state_file_read(const char *path)
+{
+    FILE        *fp = NULL;
+    char        *line = NULL;
+    size_t      size = 0;
+    ssize_t     nbytes;
+
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        return NULL;
     }
 
-    return(0);
-} /*_sysd_process_daemons() */
-
+    nbytes = getline(&line, &size, fp);
+    fclose(fp);
 
-static int
-_sysd_process_mgmt_intf(struct shash *object)
-{
-    const struct shash_node *dnode;
-    struct json *jp;
-    static bool is_mgmt_intf_present = false;
-
-    SHASH_FOR_EACH (dnode, object) {
-        if (strncmp(dnode->name, MGMT_INTF_NAME_TAG, strlen(MGMT_INTF_NAME_TAG)) == 0) {
-            jp = dnode->data;
-            switch (jp->type) {
-                case JSON_STRING:
-                    mgmt_intf = xcalloc(sizeof(mgmt_intf_info_t), 0);
-
-                    strncpy(mgmt_intf->name,jp->u.string,strlen(jp->u.string));
-                    is_mgmt_intf_present = true;
-                    VLOG_DBG("Management Interface read successfully: %s",mgmt_intf->name);
-                    break;
-                default:
-                    VLOG_ERR("Error retreiving management interface name");
-                    break;
-            }
-
-            if (is_mgmt_intf_present == false)
-            {
-                VLOG_ERR("Management interface not present in image.manifest file");
-                return -1;
-            }
-
-            return 0;
-        }
+    if (nbytes <= 0) {
+        free(line);
+        return NULL;
     }
 
-    if (is_mgmt_intf_present == false)
-    {
-        VLOG_ERR("Management interface not present in image.manifest file");
-        return -1;
+    if (line[nbytes - 1] == '\n') {
+        line[nbytes - 1] = '\0';
     }
 
-    return(0);
-} /*_sysd_process_mgmt_intf() */
+    return line;
 
+} /* sysd_state_file_read */
 
+/*
+ * Replaces the sysd state file at 'path' with 'data'.  The file is
+ * written to a temporary name and renamed into place so that a crash
+ * never leaves a truncated file behind.
+ */
 int
-sysd_process_json(struct json *json)
+sysd_state_file_write(const char *path, const char *data)
 {
-    struct shash *object;
-    struct json_array *array;
-    const struct shash_node *node;
-    struct json *jp;
-    int i;
-
-    /* The approach is to recursively look for type==OBJECT and then
-       ...see if it is what we care about (for now, only "dameons").
-       ...When we find something we care about, call a specific function
-       ...to process it. */
-
-    switch (json->type) {
-        case JSON_OBJECT:
-            object = json_object(json);
-
-            SHASH_FOR_EACH (node, object) {
-                jp = node->data;
-                if (jp->type == JSON_OBJECT) {
-                    if (strncmp(node->name, DAEMONS_TAG, strlen(DAEMONS_TAG))
-                                                        == 0) {
-                        if (_sysd_process_daemons(json_object(node->data))) {
-                            return (-1);
-                        }
-                    }
-                    else if (strncmp(node->name, MGMT_INTF_TAG, strlen(MGMT_INTF_TAG)) == 0)
-                    {
-                        if (_sysd_process_mgmt_intf(json_object(node->data)))
-                        {
-                            return (-1);
-                        }
-                    }
-                    else
-                    {
-                        if (sysd_process_json(jp)) {
-                            return (-1);
-                        }
-                    }
-                }
-                else
-                {
-                    if (jp->type == JSON_ARRAY) {
-                        /* Don't yet care about anything that is an array
-                           ...so just keep looking in case what we do care
-                           ...about is nested inside an array. */
-                        if (sysd_process_json(jp)) {
-                            return (-1);
-                        }
-                    }
-                }
-                /* Ignore anything that isn't an object or array. */
-            }
-            break;
-        case JSON_ARRAY:
-            /* Don't yet care about anything that is an array
-               ...so just keep looking in case what we do care
-               ...about is nested inside an array. */
-
-            array = json_array(json);
-
-            for (i = 0; i < (int) array->n; i++) {
-                jp = array->elems[i];
-                if (sysd_process_json(jp)) {
-                    return (-1);
-                }
-            }
-            break;
-        default:
-            /* Ignore anything that isn't an object or array. */
-            break;
-    }
+    char        tmp_path[1024];
+    FILE        *fp = NULL;
+    int         rc = 0;
 
-    return(0);
-} /* sysd_process_json() */
+    if (sysd_state_dir_create()) {
+        return -1;
+    }
 
-static void
-sysd_set_num_hw_daemons()
-{
-    int i;
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
 
-    num_hw_daemons = 0;
-    for (i = 0; i < num_daemons; i++) {
-        if (daemons[i]->is_hw_handler) {
-            num_hw_daemons++;
-        }
+    fp = fopen(tmp_path, "w");
+    if (fp == NULL) {
+        VLOG_ERR("Unable to open %s. Error %s", tmp_path, ovs_strerror(errno));
+        return -1;
     }
-    return;
-} /* sysd_set_num_hw_daemons() */
 
-int
-sysd_read_manifest_file(void)
-{
-    manifest_info = json_from_file(IMAGE_MANIFEST_FILE_PATH);
+    if (fprintf(fp, "%s\n", data) < 0) {
+        rc = -1;
+    }
+    if (fclose(fp) != 0) {
+        rc = -1;
+    }
 
-    if (manifest_info == (struct json *) NULL) {
-        return -1;
+    if (rc == 0 && rename(tmp_path, path) != 0) {
+        rc = -1;
     }
 
-    /* The top level JSON blob must be either OBJECT or ARRAY. */
-    if ((manifest_info->type != JSON_OBJECT) &&
-                            (manifest_info->type != JSON_ARRAY)) {
-        VLOG_ERR("invalid JSON type of %d", (int)manifest_info->type);
-        return (-1);
+    if (rc) {
+        VLOG_ERR("Failed to write %s. Error %s", path, ovs_strerror(errno));
+        remove(tmp_path);
     }
 
-    if (sysd_process_json(manifest_info)) {
+    return rc;
+
+} /* sysd_state_file_write */
+
+int
+sysd_read_manifest_file(void)
+{
+    if (sysd_manifest_read_file(IMAGE_MANIFEST_FILE_PATH)) {
         VLOG_ERR("Error processing %s", IMAGE_MANIFEST_FILE_PATH);
         return(-1);
     }
 
-    json_destroy(manifest_info);
+    VLOG_INFO("Readiness watchdog: default timeout %lld ms, quorum %"PRIuSIZE,
+              daemon_registry.default_timeout_msec, daemon_registry.quorum);
 
-    sysd_set_num_hw_daemons();
+    sysd_daemon_registry_count_hw(&daemon_registry);
+
+    /* Resolve depends_on lists into the readiness graph. */
+    if (sysd_daemon_registry_build_graph(&daemon_registry)) {
+        VLOG_ERR("Invalid daemon dependencies in %s",
+                 IMAGE_MANIFEST_FILE_PATH);
+        return(-1);
+    }
 
     return(0);
 } /* sysd_read_manifest_file() */